@@ -0,0 +1,243 @@
+#include "Bug.h"
+#include <string>
+#include <string_view>
+#include <charconv>
+#include <system_error>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+using namespace std;
+
+/**
+ * Validates if a title meets the requirements
+ * @param title The title to validate
+ * @return true if title is valid (not empty and <= 100 chars), false otherwise
+ */
+bool isValidTitle(const string& title) {
+    return !title.empty() && title.length() <= 100;
+}
+
+/**
+ * Validates if a description meets the requirements
+ * @param description The description to validate
+ * @return true if description is valid (not empty and <= 1000 chars), false otherwise
+ */
+bool isValidDescription(const string& description) {
+    return !description.empty() && description.length() <= 1000;
+}
+
+/**
+ * Parses a priority name (case-insensitive)
+ * @param name The priority to parse
+ * @param priority Receives the parsed priority
+ * @return true if name is "low", "medium", or "high", false otherwise
+ */
+bool parsePriority(const string& name, Priority& priority) {
+    string lower = name;
+    transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+    if (lower == "low") priority = Priority::Low;
+    else if (lower == "medium") priority = Priority::Medium;
+    else if (lower == "high") priority = Priority::High;
+    else return false;
+    return true;
+}
+
+/**
+ * Parses a status name (case-insensitive)
+ * @param name The status to parse
+ * @param status Receives the parsed status
+ * @return true if name is "open", "in progress", or "resolved", false otherwise
+ */
+bool parseStatus(const string& name, Status& status) {
+    string lower = name;
+    transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+    if (lower == "open") status = Status::Open;
+    else if (lower == "in progress") status = Status::InProgress;
+    else if (lower == "resolved") status = Status::Resolved;
+    else return false;
+    return true;
+}
+
+/**
+ * Validates if a priority value is valid
+ * @param priority The priority to validate
+ * @return true if priority is "low", "medium", or "high" (case-insensitive), false otherwise
+ */
+bool isValidPriority(const string& priority) {
+    Priority parsed;
+    return parsePriority(priority, parsed);
+}
+
+/**
+ * Validates if a status value is valid
+ * @param status The status to validate
+ * @return true if status is "open", "in progress", or "resolved" (case-insensitive), false otherwise
+ */
+bool isValidStatus(const string& status) {
+    Status parsed;
+    return parseStatus(status, parsed);
+}
+
+/**
+ * Parses a bug ID without allocating
+ * Accepts only a positive decimal integer with no sign, leading zeros or whitespace
+ * @param text The text to parse
+ * @param id Receives the parsed ID
+ * @return true if text is a valid ID within the SQLite int64 range, false otherwise
+ */
+bool parseBugId(string_view text, BugId& id) {
+    if (text.empty() || text[0] < '1' || text[0] > '9') {
+        return false;
+    }
+    long long value;
+    const char* end = text.data() + text.size();
+    auto result = from_chars(text.data(), end, value);
+    // from_chars reports values beyond the int64 range as result_out_of_range
+    if (result.ec != errc() || result.ptr != end) {
+        return false;
+    }
+    id.value = value;
+    return true;
+}
+
+/**
+ * Validates if a bug ID is a valid positive integer
+ * @param id The ID to validate
+ * @return true if ID is a positive integer within the SQLite int64 range, false otherwise
+ */
+bool isValidBugId(const string& id) {
+    BugId parsed;
+    return parseBugId(id, parsed);
+}
+
+/**
+ * Returns the current time in Unix epoch milliseconds, the unit of every stored timestamp
+ */
+sqlite3_int64 currentTimeMs() {
+    return chrono::duration_cast<chrono::milliseconds>(chrono::system_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Days from 1970-01-01 to a date of the proleptic Gregorian calendar
+ */
+static long long daysFromCivil(long long year, unsigned month, unsigned day) {
+    year -= month <= 2;
+    long long era = (year >= 0 ? year : year - 399) / 400;
+    unsigned yearOfEra = static_cast<unsigned>(year - era * 400);
+    unsigned dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    unsigned dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + static_cast<long long>(dayOfEra) - 719468;
+}
+
+/**
+ * Parses a fixed number of decimal digits
+ * @return true if text holds exactly the digits, false otherwise
+ */
+static bool parseDigits(string_view text, unsigned& value) {
+    auto result = from_chars(text.data(), text.data() + text.size(), value);
+    return !text.empty() && text[0] != '+' && text[0] != '-' &&
+        result.ec == errc() && result.ptr == text.data() + text.size();
+}
+
+/**
+ * Parses a point in time given as Unix epoch milliseconds or as a UTC date, optionally with a time of day
+ * Accepts "1735689600000", "2025-01-01", "2025-01-01T12:30" and "2025-01-01 12:30:45"; a trailing Z is ignored.
+ * @param text The text to parse
+ * @param ms Receives the time in Unix epoch milliseconds
+ * @return true if text is a valid timestamp, false otherwise
+ */
+bool parseTimestamp(string_view text, sqlite3_int64& ms) {
+    if (!text.empty() && text.back() == 'Z') {
+        text.remove_suffix(1);
+    }
+    if (text.find('-') == string_view::npos) {
+        long long value;
+        auto result = from_chars(text.data(), text.data() + text.size(), value);
+        if (text.empty() || result.ec != errc() || result.ptr != text.data() + text.size()) {
+            return false;
+        }
+        ms = value;
+        return true;
+    }
+
+    unsigned year, month, day, hour = 0, minute = 0, second = 0;
+    if (text.size() < 10 || text[4] != '-' || text[7] != '-' ||
+        !parseDigits(text.substr(0, 4), year) || !parseDigits(text.substr(5, 2), month) ||
+        !parseDigits(text.substr(8, 2), day)) {
+        return false;
+    }
+    if (text.size() > 10) {
+        if ((text[10] != 'T' && text[10] != ' ') || (text.size() != 16 && text.size() != 19) || text[13] != ':' ||
+            !parseDigits(text.substr(11, 2), hour) || !parseDigits(text.substr(14, 2), minute) ||
+            (text.size() == 19 && (text[16] != ':' || !parseDigits(text.substr(17, 2), second)))) {
+            return false;
+        }
+    }
+    static const unsigned daysInMonth[] = { 31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    bool leap = year % 4 == 0 && (year % 100 != 0 || year % 400 == 0);
+    if (month < 1 || month > 12 || day < 1 || day > daysInMonth[month - 1] || (month == 2 && day == 29 && !leap) ||
+        hour > 23 || minute > 59 || second > 59) {
+        return false;
+    }
+    ms = ((daysFromCivil(year, month, day) * 24 + hour) * 60 + minute) * 60000LL + second * 1000LL;
+    return true;
+}
+
+/**
+ * Formats Unix epoch milliseconds as a UTC date and time, e.g. "2025-01-01 12:30:45"
+ */
+string formatTimestamp(sqlite3_int64 ms) {
+    char text[TIMESTAMP_TEXT_SIZE];
+    return string(formatTimestamp(ms, text));
+}
+
+/**
+ * Formats Unix epoch milliseconds as a UTC date and time into a caller's buffer, without allocating
+ * @param ms Unix epoch milliseconds
+ * @param text Receives the null-terminated text
+ * @return The formatted text, pointing into text
+ */
+string_view formatTimestamp(sqlite3_int64 ms, char (&text)[TIMESTAMP_TEXT_SIZE]) {
+    long long seconds = ms >= 0 ? ms / 1000 : (ms - 999) / 1000;
+    long long days = seconds >= 0 ? seconds / 86400 : (seconds - 86399) / 86400;
+    long long secondOfDay = seconds - days * 86400;
+
+    // Inverse of daysFromCivil()
+    long long shifted = days + 719468;
+    long long era = (shifted >= 0 ? shifted : shifted - 146096) / 146097;
+    unsigned dayOfEra = static_cast<unsigned>(shifted - era * 146097);
+    unsigned yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    unsigned dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    unsigned monthIndex = (5 * dayOfYear + 2) / 153;
+    unsigned day = dayOfYear - (153 * monthIndex + 2) / 5 + 1;
+    unsigned month = monthIndex < 10 ? monthIndex + 3 : monthIndex - 9;
+    long long year = yearOfEra + era * 400 + (month <= 2);
+
+    int length = snprintf(text, sizeof(text), "%04lld-%02u-%02u %02lld:%02lld:%02lld", year, month, day,
+        secondOfDay / 3600, secondOfDay / 60 % 60, secondOfDay % 60);
+    return string_view(text, length);
+}
+
+/**
+ * Views an owned bug, e.g. to format it with code written for row views
+ * @param bug The bug, which must outlive the view
+ */
+BugView viewOf(const Bug& bug) {
+    return BugView{ bug.id, bug.title, bug.description, bug.status, bug.priority, bug.created, bug.updated };
+}
+
+/**
+ * Copies a row view into an owned bug, reusing the bug's string buffers
+ * @param bug Receives the fields
+ * @param view A view whose row is still current
+ */
+void assignBug(Bug& bug, const BugView& view) {
+    bug.id = view.id;
+    bug.title.assign(view.title);
+    bug.description.assign(view.description);
+    bug.status = view.status;
+    bug.priority = view.priority;
+    bug.created = view.created;
+    bug.updated = view.updated;
+}
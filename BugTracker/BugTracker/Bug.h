@@ -0,0 +1,100 @@
+#pragma once
+
+// Include SQLite3 C API: the vendored header, or the system library's when CMake links that instead
+extern "C" {
+#ifdef BUGTRACKER_SQLITE_HEADER
+#include BUGTRACKER_SQLITE_HEADER
+#else
+#include "sqlite3.h"
+#endif
+}
+#include <string>
+#include <string_view>
+
+/**
+ * Bug priorities as stored in the Priority column
+ */
+enum class Priority {
+    Low = 0,
+    Medium = 1,
+    High = 2
+};
+
+/**
+ * Bug statuses as stored in the Status column
+ */
+enum class Status {
+    Open = 0,
+    InProgress = 1,
+    Resolved = 2
+};
+
+// Display names indexed by the stored integer value
+inline constexpr const char* PRIORITY_NAMES[] = { "Low", "Medium", "High" };
+inline constexpr const char* STATUS_NAMES[] = { "Open", "In Progress", "Resolved" };
+
+/**
+ * A bug ID parsed once from user input and bound to statements as an integer,
+ * so lookups go straight to the rowid without type conversion
+ */
+struct BugId {
+    sqlite3_int64 value;
+};
+
+/**
+ * A bug as stored in the bugs table
+ */
+struct Bug {
+    BugId id;
+    std::string title;
+    std::string description;
+    Status status;
+    Priority priority;
+    sqlite3_int64 created;  // Unix epoch milliseconds
+    sqlite3_int64 updated;  // Last status change, or created if there was none
+};
+
+/**
+ * A bug read in place from the current row of a statement, without copying its text
+ * The strings point into SQLite's row buffer and are only valid until the statement is
+ * stepped, reset or finalized; copy the view into a Bug to keep it longer.
+ */
+struct BugView {
+    BugId id;
+    std::string_view title;
+    std::string_view description;
+    Status status;
+    Priority priority;
+    sqlite3_int64 created;
+    sqlite3_int64 updated;
+};
+
+/**
+ * The fields supplied when filing a new bug; the rest are assigned by the database
+ */
+struct NewBug {
+    std::string title;
+    std::string description;
+    Priority priority;
+};
+
+// Parsing and validation
+bool isValidTitle(const std::string& title);
+bool isValidDescription(const std::string& description);
+bool parsePriority(const std::string& name, Priority& priority);
+bool parseStatus(const std::string& name, Status& status);
+bool isValidPriority(const std::string& priority);
+bool isValidStatus(const std::string& status);
+bool parseBugId(std::string_view text, BugId& id);
+bool isValidBugId(const std::string& id);
+
+// Timestamps; formatted times need TIMESTAMP_TEXT_SIZE bytes including the terminating null
+inline constexpr size_t TIMESTAMP_TEXT_SIZE = 32;
+sqlite3_int64 currentTimeMs();
+bool parseTimestamp(std::string_view text, sqlite3_int64& ms);
+std::string formatTimestamp(sqlite3_int64 ms);
+std::string_view formatTimestamp(sqlite3_int64 ms, char (&text)[TIMESTAMP_TEXT_SIZE]);
+
+// Conversions between owned bugs and row views
+BugView viewOf(const Bug& bug);
+void assignBug(Bug& bug, const BugView& view);
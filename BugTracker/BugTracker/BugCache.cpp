@@ -0,0 +1,175 @@
+#include "BugCache.h"
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+// Per-entry bookkeeping on top of the Bug itself: the list node's two links, the hash node
+// (next pointer, key, iterator, cached hash) and its bucket slot
+const size_t ENTRY_OVERHEAD_BYTES = 7 * sizeof(void*);
+
+/**
+ * Returns the heap memory a string holds; short strings live inside the object itself
+ */
+static size_t heapBytes(const string& text) {
+    static const size_t inlineCapacity = string().capacity();
+    return text.capacity() > inlineCapacity ? text.capacity() + 1 : 0;
+}
+
+/**
+ * Estimates the memory an entry for the bug takes
+ */
+static size_t entryBytes(const Bug& bug) {
+    return sizeof(size_t) + sizeof(Bug) + ENTRY_OVERHEAD_BYTES +
+        heapBytes(bug.title) + heapBytes(bug.description);
+}
+
+/**
+ * @param capacityBytes Memory cap; 0 keeps nothing
+ */
+BugCache::BugCache(size_t capacityBytes) : capacityBytes(capacityBytes) {
+}
+
+/**
+ * Changes the memory cap, evicting the least recently used bugs if the cache is now over it
+ * @param capacityBytes Memory cap; 0 keeps nothing
+ */
+void BugCache::setCapacity(size_t capacityBytes) {
+    lock_guard<mutex> lock(cacheMutex);
+    this->capacityBytes = capacityBytes;
+    evictOverCapacity();
+}
+
+/**
+ * Looks up a bug and marks it as most recently used
+ * @param id The bug ID
+ * @param bug Receives a copy of the cached bug on a hit
+ * @return true on a hit, false on a miss
+ */
+bool BugCache::find(BugId id, Bug& bug) {
+    lock_guard<mutex> lock(cacheMutex);
+    auto it = index.find(id.value);
+    if (it == index.end()) {
+        misses++;
+        return false;
+    }
+    hits++;
+    entries.splice(entries.begin(), entries, it->second);
+    bug = it->second->bug;
+    return true;
+}
+
+/**
+ * Returns the change counter to pass to insert() for a row about to be read from the database
+ */
+unsigned long long BugCache::generation() const {
+    lock_guard<mutex> lock(cacheMutex);
+    return changes;
+}
+
+/**
+ * Caches a bug read from the database as most recently used
+ * @param bug The bug as read
+ * @param readGeneration generation() from before the read; if anything changed since, the row may be stale and is dropped
+ */
+void BugCache::insert(const Bug& bug, unsigned long long readGeneration) {
+    size_t size = entryBytes(bug);
+    lock_guard<mutex> lock(cacheMutex);
+    if (readGeneration != changes || size > capacityBytes) {
+        return;
+    }
+
+    auto it = index.find(bug.id.value);
+    if (it != index.end()) {
+        bytes -= it->second->bytes;
+        it->second->bug = bug;
+        it->second->bytes = size;
+        entries.splice(entries.begin(), entries, it->second);
+    } else {
+        entries.push_front({ bug, size });
+        index.emplace(bug.id.value, entries.begin());
+    }
+    bytes += size;
+    evictOverCapacity();
+}
+
+/**
+ * Writes a committed status change through to the cached bug, if it is cached
+ * @param id The bug ID
+ * @param status The new status
+ * @param updatedMs The time of the change, Unix epoch milliseconds
+ */
+void BugCache::updateStatus(BugId id, Status status, sqlite3_int64 updatedMs) {
+    lock_guard<mutex> lock(cacheMutex);
+    changes++;
+    auto it = index.find(id.value);
+    if (it != index.end()) {
+        it->second->bug.status = status;
+        it->second->bug.updated = updatedMs;
+    }
+}
+
+/**
+ * Drops a bug that was deleted or changed in a way the cache cannot apply
+ * @param id The bug ID
+ */
+void BugCache::erase(BugId id) {
+    lock_guard<mutex> lock(cacheMutex);
+    changes++;
+    auto it = index.find(id.value);
+    if (it != index.end()) {
+        bytes -= it->second->bytes;
+        entries.erase(it->second);
+        index.erase(it);
+    }
+}
+
+/**
+ * Drops every cached bug; the counters are kept
+ */
+void BugCache::clear() {
+    lock_guard<mutex> lock(cacheMutex);
+    changes++;
+    entries.clear();
+    index.clear();
+    bytes = 0;
+}
+
+/**
+ * Evicts least recently used bugs until the cache fits its memory cap; the lock must be held
+ */
+void BugCache::evictOverCapacity() {
+    while (bytes > capacityBytes && !entries.empty()) {
+        Entry& last = entries.back();
+        bytes -= last.bytes;
+        index.erase(last.bug.id.value);
+        entries.pop_back();
+        evictions++;
+    }
+}
+
+/**
+ * Returns a consistent snapshot of the counters
+ */
+BugCacheStats BugCache::stats() const {
+    lock_guard<mutex> lock(cacheMutex);
+    BugCacheStats stats;
+    stats.hits = hits;
+    stats.misses = misses;
+    stats.evictions = evictions;
+    stats.entries = index.size();
+    stats.bytes = bytes;
+    stats.capacityBytes = capacityBytes;
+    return stats;
+}
+
+/**
+ * Prints the hit rate and memory footprint counters
+ */
+void BugCache::printStats() const {
+    BugCacheStats stats = this->stats();
+    cerr << "Bug cache: " << stats.hits << " hits, " << stats.misses << " misses ("
+        << static_cast<int>(stats.hitRate() * 100 + 0.5) << "% hit rate), "
+        << stats.entries << " bugs in " << stats.bytes / 1024 << " of " << stats.capacityBytes / 1024 << " KiB, "
+        << stats.evictions << " evictions" << endl;
+}
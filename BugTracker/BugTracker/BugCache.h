@@ -0,0 +1,73 @@
+#pragma once
+
+#include "Bug.h"
+#include <cstddef>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+// Memory cap of a bug cache when none is configured
+inline constexpr size_t DEFAULT_BUG_CACHE_BYTES = 32 * 1024 * 1024;
+
+/**
+ * Counters of a BugCache, read together under its lock
+ */
+struct BugCacheStats {
+    unsigned long long hits = 0;
+    unsigned long long misses = 0;
+    unsigned long long evictions = 0;   // Entries dropped to stay under the memory cap
+    size_t entries = 0;
+    size_t bytes = 0;                   // Estimated memory held by the entries, strings included
+    size_t capacityBytes = 0;
+
+    double hitRate() const { return hits + misses > 0 ? static_cast<double>(hits) / (hits + misses) : 0.0; }
+};
+
+/**
+ * Least-recently-used cache of Bug records keyed by ID, bounded by an estimated memory footprint
+ * A BugRepository given the cache with setCache() serves get() from it and writes its own status
+ * changes and deletes through to it, so several repositories (one per thread) can share one cache.
+ * Only single-bug lookups fill it; listing pages and searches go straight to the database and
+ * cannot flush the recently used bugs out.
+ * Every change bumps a generation counter. A repository reads the generation before going to the
+ * database and insert() drops the row if a change happened in between, so a lookup that raced a
+ * commit never caches the old row.
+ */
+class BugCache {
+public:
+    explicit BugCache(size_t capacityBytes = DEFAULT_BUG_CACHE_BYTES);
+    BugCache(const BugCache&) = delete;
+    BugCache& operator=(const BugCache&) = delete;
+
+    void setCapacity(size_t capacityBytes);
+    bool find(BugId id, Bug& bug);
+    unsigned long long generation() const;
+    void insert(const Bug& bug, unsigned long long readGeneration);
+    void updateStatus(BugId id, Status status, sqlite3_int64 updatedMs);
+    void erase(BugId id);
+    void clear();
+
+    BugCacheStats stats() const;
+    void printStats() const;
+
+private:
+    /**
+     * A cached bug and the memory charged for it
+     */
+    struct Entry {
+        Bug bug;
+        size_t bytes;
+    };
+
+    void evictOverCapacity();
+
+    mutable std::mutex cacheMutex;
+    std::list<Entry> entries;   // Most recently used first
+    std::unordered_map<sqlite3_int64, std::list<Entry>::iterator> index;
+    size_t capacityBytes;
+    size_t bytes = 0;
+    unsigned long long changes = 0;
+    unsigned long long hits = 0;
+    unsigned long long misses = 0;
+    unsigned long long evictions = 0;
+};
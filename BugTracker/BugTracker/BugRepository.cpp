@@ -0,0 +1,1212 @@
+#include "BugRepository.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+using namespace std;
+
+/**
+ * A schema migration step; user_version is set to the version once its SQL has run
+ */
+struct SchemaMigration {
+    int version;
+    const char* sql;
+};
+
+/**
+ * Schema migrations in the order they are applied
+ * Existing steps must never change; add a new step with the next version instead
+ */
+const SchemaMigration SCHEMA_MIGRATIONS[] = {
+    // 1: the original bugs table
+    { 1, R"(CREATE TABLE IF NOT EXISTS bugs (
+        ID INTEGER PRIMARY KEY AUTOINCREMENT,
+        Title TEXT NOT NULL,
+        Description TEXT,
+        Status TEXT DEFAULT 'Open',
+        Priority TEXT,
+        Date TEXT DEFAULT CURRENT_DATE
+    );)" },
+
+    // 2: indexes for filtering by status, priority and date
+    { 2, R"(CREATE INDEX IF NOT EXISTS idx_bugs_status_priority ON bugs (Status, Priority);
+        CREATE INDEX IF NOT EXISTS idx_bugs_priority ON bugs (Priority);
+        CREATE INDEX IF NOT EXISTS idx_bugs_date ON bugs (Date);)" },
+
+    // 3: Status and Priority stored as small integers (see Status and Priority enums).
+    // The table is rebuilt because SQLite cannot change a column type or add a CHECK in place;
+    // the AUTOINCREMENT counter is carried over so deleted IDs are never reused.
+    { 3, R"(CREATE TABLE bugs_new (
+        ID INTEGER PRIMARY KEY AUTOINCREMENT,
+        Title TEXT NOT NULL,
+        Description TEXT,
+        Status INTEGER NOT NULL DEFAULT 0 CHECK (Status BETWEEN 0 AND 2),
+        Priority INTEGER NOT NULL DEFAULT 0 CHECK (Priority BETWEEN 0 AND 2),
+        Date TEXT DEFAULT CURRENT_DATE
+    );
+    INSERT INTO bugs_new (ID, Title, Description, Status, Priority, Date)
+        SELECT ID, Title, Description,
+            CASE lower(Status) WHEN 'in progress' THEN 1 WHEN 'resolved' THEN 2 ELSE 0 END,
+            CASE lower(Priority) WHEN 'medium' THEN 1 WHEN 'high' THEN 2 ELSE 0 END,
+            Date
+        FROM bugs;
+    DELETE FROM sqlite_sequence WHERE name = 'bugs_new';
+    UPDATE sqlite_sequence SET name = 'bugs_new' WHERE name = 'bugs';
+    DROP TABLE bugs;
+    ALTER TABLE bugs_new RENAME TO bugs;
+    CREATE INDEX idx_bugs_status_priority ON bugs (Status, Priority);
+    CREATE INDEX idx_bugs_priority ON bugs (Priority);
+    CREATE INDEX idx_bugs_date ON bugs (Date);)" },
+
+    // 4: full-text index over Title and Description. The FTS5 table stores only the index and reads
+    // the text back from bugs (external content); triggers keep it in step with every change.
+    // Status changes do not touch the index. Title matches weigh ten times as much as Description
+    // matches in the BM25 rank.
+    { 4, R"(CREATE VIRTUAL TABLE bugs_fts USING fts5(
+        Title, Description,
+        content = 'bugs', content_rowid = 'ID',
+        tokenize = 'unicode61 remove_diacritics 2'
+    );
+    CREATE TRIGGER bugs_fts_insert AFTER INSERT ON bugs BEGIN
+        INSERT INTO bugs_fts (rowid, Title, Description) VALUES (new.ID, new.Title, new.Description);
+    END;
+    CREATE TRIGGER bugs_fts_delete AFTER DELETE ON bugs BEGIN
+        INSERT INTO bugs_fts (bugs_fts, rowid, Title, Description) VALUES ('delete', old.ID, old.Title, old.Description);
+    END;
+    CREATE TRIGGER bugs_fts_update AFTER UPDATE OF Title, Description ON bugs BEGIN
+        INSERT INTO bugs_fts (bugs_fts, rowid, Title, Description) VALUES ('delete', old.ID, old.Title, old.Description);
+        INSERT INTO bugs_fts (rowid, Title, Description) VALUES (new.ID, new.Title, new.Description);
+    END;
+    INSERT INTO bugs_fts (bugs_fts, rank) VALUES ('rank', 'bm25(10.0, 1.0)');
+    INSERT INTO bugs_fts (bugs_fts) VALUES ('rebuild');)" },
+
+    // 5: new bugs are indexed by BugRepository::add() instead of a trigger. FTS5 indexes rows
+    // inserted from a trigger several times slower than rows inserted directly, which capped
+    // batched inserts at roughly 20,000 rows/sec. Delete and update stay with triggers.
+    { 5, R"(DROP TRIGGER bugs_fts_insert;)" },
+
+    // 6: bug counts per (Status, Priority), so dashboards never run a GROUP BY over bugs. All nine
+    // pairs exist up front, so maintaining them only ever updates a row. Like the full-text index,
+    // BugRepository::add() counts new bugs itself; an insert trigger cut bulk inserts from
+    // ~134,000 to ~30,000 rows/sec. Triggers handle deletes and status or priority changes.
+    { 6, R"(CREATE TABLE bug_counts (
+        Status INTEGER NOT NULL,
+        Priority INTEGER NOT NULL,
+        Count INTEGER NOT NULL DEFAULT 0,
+        PRIMARY KEY (Status, Priority)
+    ) WITHOUT ROWID;
+    WITH value(v) AS (VALUES (0), (1), (2))
+        INSERT INTO bug_counts (Status, Priority, Count)
+        SELECT status.v, priority.v, 0 FROM value AS status, value AS priority;
+    UPDATE bug_counts SET Count = (SELECT COUNT(*) FROM bugs
+        WHERE bugs.Status = bug_counts.Status AND bugs.Priority = bug_counts.Priority);
+    CREATE TRIGGER bug_counts_delete AFTER DELETE ON bugs BEGIN
+        UPDATE bug_counts SET Count = Count - 1 WHERE Status = old.Status AND Priority = old.Priority;
+    END;
+    CREATE TRIGGER bug_counts_update AFTER UPDATE OF Status, Priority ON bugs
+    WHEN old.Status <> new.Status OR old.Priority <> new.Priority BEGIN
+        UPDATE bug_counts SET Count = Count - 1 WHERE Status = old.Status AND Priority = old.Priority;
+        UPDATE bug_counts SET Count = Count + 1 WHERE Status = new.Status AND Priority = new.Priority;
+    END;)" },
+
+    // 7: append-only history of every bug. Each row is one event: filing (OldStatus NULL), a status
+    // change, or deletion (NewStatus NULL), stamped in Unix epoch milliseconds. add() records filing
+    // itself like the other derived tables; triggers record status changes and deletes in the same
+    // statement as the change. Existing bugs get a filing event dated from their Date column.
+    { 7, R"(CREATE TABLE bug_events (
+        ID INTEGER PRIMARY KEY,
+        BugID INTEGER NOT NULL,
+        Ts INTEGER NOT NULL,
+        OldStatus INTEGER,
+        NewStatus INTEGER
+    );
+    CREATE INDEX idx_bug_events_bug ON bug_events (BugID, Ts);
+    CREATE INDEX idx_bug_events_status ON bug_events (NewStatus, Ts, BugID);
+    INSERT INTO bug_events (BugID, Ts, OldStatus, NewStatus)
+        SELECT ID, CAST((COALESCE(julianday(Date), julianday('now')) - 2440587.5) * 86400000 AS INTEGER), NULL, 0
+        FROM bugs ORDER BY ID;
+    CREATE TRIGGER bug_events_status AFTER UPDATE OF Status ON bugs WHEN old.Status <> new.Status BEGIN
+        INSERT INTO bug_events (BugID, Ts, OldStatus, NewStatus)
+        VALUES (new.ID, CAST((julianday('now') - 2440587.5) * 86400000 AS INTEGER), old.Status, new.Status);
+    END;
+    CREATE TRIGGER bug_events_delete AFTER DELETE ON bugs BEGIN
+        INSERT INTO bug_events (BugID, Ts, OldStatus, NewStatus)
+        VALUES (old.ID, CAST((julianday('now') - 2440587.5) * 86400000 AS INTEGER), old.Status, NULL);
+    END;
+    CREATE TRIGGER bug_events_no_update BEFORE UPDATE ON bug_events BEGIN
+        SELECT RAISE(ABORT, 'bug_events is append-only');
+    END;
+    CREATE TRIGGER bug_events_no_delete BEFORE DELETE ON bug_events BEGIN
+        SELECT RAISE(ABORT, 'bug_events is append-only');
+    END;)" },
+
+    // 8: Date TEXT (a day-resolution string) replaced by Created and Updated in Unix epoch milliseconds,
+    // so time windows compare integers and bugs filed on the same day keep their order. Created comes
+    // from Date and Updated from the last history event. add() sets both and updateStatus() sets Updated;
+    // the columns cannot default to the current time, since ADD COLUMN only takes constant defaults.
+    // Created is appended to the status index, so aging reads no bug rows.
+    { 8, R"(ALTER TABLE bugs ADD COLUMN Created INTEGER NOT NULL DEFAULT 0;
+    ALTER TABLE bugs ADD COLUMN Updated INTEGER NOT NULL DEFAULT 0;
+    UPDATE bugs SET Created = CAST((COALESCE(julianday(Date), julianday('now')) - 2440587.5) * 86400000 AS INTEGER);
+    UPDATE bugs SET Updated = MAX(Created, COALESCE((SELECT MAX(Ts) FROM bug_events WHERE BugID = bugs.ID), 0));
+    DROP INDEX idx_bugs_date;
+    ALTER TABLE bugs DROP COLUMN Date;
+    DROP INDEX idx_bugs_status_priority;
+    CREATE INDEX idx_bugs_status_priority ON bugs (Status, Priority, Created);
+    CREATE INDEX idx_bugs_created ON bugs (Created);)" },
+
+    // 9: indexes for filtered listings (see BugRepository::filterQuery()), which return bugs in filing
+    // order. Each status or priority filter gets an index ending in Created, so its rows come out of the
+    // index already ordered and inside the --since/--until range, and never need a sort.
+    { 9, R"(DROP INDEX idx_bugs_priority;
+    CREATE INDEX idx_bugs_priority_created ON bugs (Priority, Created);
+    CREATE INDEX idx_bugs_status_created ON bugs (Status, Created);)" },
+
+    // 10: every event time from the same clock as Created and Updated. The triggers of version 7 stamped
+    // events with SQLite's julianday('now'), so a status change got one time in Updated and another in
+    // its event. Status changes now take Ts from the Updated value updateStatus() sets in the same
+    // statement, and remove() records deletions itself, with the time it reads, in the delete's transaction.
+    { 10, R"(DROP TRIGGER bug_events_status;
+    CREATE TRIGGER bug_events_status AFTER UPDATE OF Status ON bugs WHEN old.Status <> new.Status BEGIN
+        INSERT INTO bug_events (BugID, Ts, OldStatus, NewStatus) VALUES (new.ID, new.Updated, old.Status, new.Status);
+    END;
+    DROP TRIGGER bug_events_delete;)" },
+};
+
+/**
+ * A built-in query and the access path its plan must use
+ */
+struct BuiltinQuery {
+    const char* sql;
+    const char* expectedPlan;   // Substring required in the plan, nullptr if only full scans are rejected;
+                                // naming a scan here allows it, for tables of a fixed handful of rows
+};
+
+const BuiltinQuery BUILTIN_QUERIES[] = {
+    { SQL_BUG_EXISTS, "USING INTEGER PRIMARY KEY (rowid=?)" },
+    { SQL_INSERT_BUG, nullptr },
+    { SQL_INDEX_BUG, nullptr },
+    { SQL_COUNT_NEW_BUG, "USING PRIMARY KEY (Status=? AND Priority=?)" },
+    { SQL_RECORD_FILED, nullptr },
+    { SQL_TIME_TO_RESOLVE, "USING COVERING INDEX idx_bug_events_status (NewStatus=? AND Ts>? AND Ts<?)" },
+    { SQL_OPEN_BUG_AGING, "USING COVERING INDEX idx_bugs_status_created (Status<?)" },
+    { SQL_GET_BUG, "USING INTEGER PRIMARY KEY (rowid=?)" },
+    { SQL_LIST_PAGE, "USING INTEGER PRIMARY KEY (rowid>?)" },
+    { SQL_LIST_RANGE, "USING INTEGER PRIMARY KEY (rowid>? AND rowid<?)" },
+    { SQL_BUG_ID_RANGE, "SEARCH bugs" },
+    { SQL_UPDATE_STATUS, "USING INTEGER PRIMARY KEY (rowid=?)" },
+    { SQL_DELETE_BUG, "USING INTEGER PRIMARY KEY (rowid=?)" },
+    { SQL_RECORD_DELETED, "USING INTEGER PRIMARY KEY (rowid=?)" },
+    { SQL_SEARCH_BUGS, "USING INTEGER PRIMARY KEY (rowid=?)" },
+    { SQL_BUG_COUNTS, "SCAN bug_counts" },
+};
+
+/**
+ * Looks up a named pragma profile
+ * @param name The profile name
+ * @param profile Receives the profile settings
+ * @return true if the profile exists, false otherwise
+ */
+bool findPragmaProfile(const string& name, PragmaProfile& profile) {
+    for (const auto& entry : PRAGMA_PROFILES) {
+        if (name == entry.first) {
+            profile = entry.second;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Checks if a keyword is one of the allowed values (case-insensitive) and normalizes it to upper case
+ * Pragma values cannot be bound as parameters, so only whitelisted keywords are ever put into the SQL
+ * @param value The keyword to check; upper-cased in place when valid
+ * @param allowed The accepted keywords in upper case
+ * @return true if the keyword is allowed, false otherwise
+ */
+bool isAllowedKeyword(string& value, const vector<string>& allowed) {
+    string upper = value;
+    transform(upper.begin(), upper.end(), upper.begin(), ::toupper);
+    if (find(allowed.begin(), allowed.end(), upper) == allowed.end()) {
+        return false;
+    }
+    value = upper;
+    return true;
+}
+
+/**
+ * Closes the connection if it is still open
+ */
+BugRepository::~BugRepository() {
+    close();
+}
+
+/**
+ * Opens the database, applies the pragma profile and migrates the schema
+ * @param path Path of the database file
+ * @param profile Connection settings to apply
+ * @return true if the database is ready to use, false otherwise
+ */
+bool BugRepository::open(const string& path, const PragmaProfile& profile) {
+    close();
+    int rc = sqlite3_open(path.c_str(), &db);
+    if (rc) {
+        cerr << "Can't open database: " << sqlite3_errmsg(db) << endl;
+        sqlite3_close(db);
+        db = nullptr;
+        return false;
+    }
+
+    if (!applyPragmaProfile(profile)) {
+        close();
+        return false;
+    }
+
+    // Create or upgrade the schema
+    if (!migrateSchema()) {
+        close();
+        return false;
+    }
+
+#ifndef NDEBUG
+    // Debug builds refuse to run if a built-in query would scan the table
+    if (!checkQueryPlans()) {
+        close();
+        return false;
+    }
+#endif
+    return true;
+}
+
+/**
+ * Opens an existing database for reading only, e.g. for one of several connections exporting it in parallel
+ * Only the read-side settings of the profile are applied; the journal mode and synchronous level belong to
+ * the writers. The schema is not migrated, so it must already be at the latest version.
+ * @param path Path of the database file
+ * @param profile Connection settings to apply
+ * @return true if the database is ready to read, false otherwise
+ */
+bool BugRepository::openReadOnly(const string& path, const PragmaProfile& profile) {
+    close();
+    int rc = sqlite3_open_v2(path.c_str(), &db, SQLITE_OPEN_READONLY, nullptr);
+    if (rc) {
+        cerr << "Can't open database: " << sqlite3_errmsg(db) << endl;
+        sqlite3_close(db);
+        db = nullptr;
+        return false;
+    }
+
+    if (!execute("PRAGMA cache_size = " + to_string(profile.cacheSize) + ";") ||
+        !execute("PRAGMA mmap_size = " + to_string(profile.mmapSize) + ";") ||
+        !execute("PRAGMA temp_store = " + profile.tempStore + ";")) {
+        close();
+        return false;
+    }
+
+    int version = schemaVersion();
+    if (version != SCHEMA_MIGRATIONS[size(SCHEMA_MIGRATIONS) - 1].version) {
+        cerr << "Database schema is at version " << version << "; open it read-write once to migrate it." << endl;
+        close();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Finalizes cached statements and closes the connection
+ */
+void BugRepository::close() {
+    if (!db) {
+        return;
+    }
+    flushCacheInvalidations();
+    clearStatementCache();
+    sqlite3_close(db);
+    db = nullptr;
+}
+
+/**
+ * Returns a prepared statement for the given SQL, preparing it only on first use
+ * Statements live as long as the connection and are finalized by close()
+ * @param sql The SQL query string to prepare
+ * @return A handle to the reset statement, empty if preparation failed
+ */
+CachedStatement BugRepository::statement(const string& sql) {
+    auto it = statements.find(sql);
+    if (it != statements.end()) {
+        cacheHits++;
+        return CachedStatement(it->second);
+    }
+
+    cacheMisses++;
+    sqlite3_stmt* stmt = nullptr;
+    int rc = sqlite3_prepare_v3(db, sql.c_str(), -1, SQLITE_PREPARE_PERSISTENT, &stmt, nullptr);
+    if (rc != SQLITE_OK) {
+        cerr << "Failed to prepare statement: " << sqlite3_errmsg(db) << endl;
+        return CachedStatement(nullptr);
+    }
+    statements.emplace(sql, stmt);
+    return CachedStatement(stmt);
+}
+
+/**
+ * Finalizes every cached statement
+ */
+void BugRepository::clearStatementCache() {
+    for (auto& entry : statements) {
+        sqlite3_finalize(entry.second);
+    }
+    statements.clear();
+}
+
+/**
+ * Prints the statement cache hit and miss counters
+ */
+void BugRepository::printStatementCacheStats() const {
+    cerr << "Statement cache: " << cacheHits << " hits, "
+        << cacheMisses << " misses, "
+        << statements.size() << " cached statements" << endl;
+}
+
+/**
+ * Executes a SQL query and handles any errors that occur
+ * Ending a transaction this way (COMMIT or ROLLBACK) drops the bugs it changed from the bug cache.
+ * @param sql The SQL query string to execute
+ * @return true if the query succeeded, false otherwise
+ */
+bool BugRepository::execute(const string& sql) {
+    char* errMsg = nullptr;
+    int rc = sqlite3_exec(db, sql.c_str(), nullptr, nullptr, &errMsg);
+    if (!uncommittedChanges.empty() && sqlite3_get_autocommit(db)) {
+        flushCacheInvalidations();
+    }
+    if (rc != SQLITE_OK) {
+        cerr << "SQL Error: " << errMsg << endl;
+        sqlite3_free(errMsg);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Puts a bug cache in front of get() and keeps it in step with this repository's changes
+ * The cache must outlive the repository or be unset first; it stays set across open() and close().
+ * @param cache The cache, possibly shared with other repositories, or nullptr for none
+ */
+void BugRepository::setCache(BugCache* cache) {
+    flushCacheInvalidations();
+    this->cache = cache;
+}
+
+/**
+ * Drops a changed bug from the cache, right away in autocommit mode or once the open transaction ends
+ * Inside a transaction the change is not visible to other connections yet, and may still roll back.
+ * @param id The bug ID
+ */
+void BugRepository::invalidateCached(BugId id) {
+    if (!cache) {
+        return;
+    }
+    if (sqlite3_get_autocommit(db)) {
+        cache->erase(id);
+    } else {
+        uncommittedChanges.push_back(id);
+    }
+}
+
+/**
+ * Drops every bug changed by the last transaction from the cache
+ */
+void BugRepository::flushCacheInvalidations() {
+    if (cache) {
+        for (BugId id : uncommittedChanges) {
+            cache->erase(id);
+        }
+    }
+    uncommittedChanges.clear();
+}
+
+/**
+ * Applies a pragma profile to the connection
+ * @param profile The settings to apply
+ * @return true if every pragma was applied, false otherwise
+ */
+bool BugRepository::applyPragmaProfile(const PragmaProfile& profile) {
+    return execute("PRAGMA journal_mode = " + profile.journalMode + ";") &&
+        execute("PRAGMA synchronous = " + profile.synchronous + ";") &&
+        execute("PRAGMA cache_size = " + to_string(profile.cacheSize) + ";") &&
+        execute("PRAGMA mmap_size = " + to_string(profile.mmapSize) + ";") &&
+        execute("PRAGMA temp_store = " + profile.tempStore + ";");
+}
+
+/**
+ * Reads the schema version recorded in user_version by the migrations
+ * @return The version, 0 for a new database or if it cannot be read
+ */
+int BugRepository::schemaVersion() {
+    int version = 0;
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(db, "PRAGMA user_version;", -1, &stmt, nullptr) == SQLITE_OK) {
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            version = sqlite3_column_int(stmt, 0);
+        }
+        sqlite3_finalize(stmt);
+    }
+    return version;
+}
+
+/**
+ * Brings the schema up to the latest version
+ * Each pending migration runs in its own transaction together with the user_version update
+ * @return true if the schema is up to date, false if a migration failed
+ */
+bool BugRepository::migrateSchema() {
+    int currentVersion = schemaVersion();
+
+    for (const auto& migration : SCHEMA_MIGRATIONS) {
+        if (migration.version <= currentVersion) {
+            continue;
+        }
+        if (!execute("BEGIN;")) {
+            return false;
+        }
+        if (!execute(migration.sql) ||
+            !execute("PRAGMA user_version = " + to_string(migration.version) + ";") ||
+            !execute("COMMIT;")) {
+            cerr << "Schema migration to version " << migration.version << " failed." << endl;
+            execute("ROLLBACK;");
+            return false;
+        }
+        currentVersion = migration.version;
+    }
+    return true;
+}
+
+/**
+ * Runs EXPLAIN QUERY PLAN on every built-in query and every shape of filtered listing, and reports any that
+ * would scan a whole table or index, that does not use the access path it is registered with, or (for
+ * listings, which must stream) that sorts its results
+ * @return true if every query is answered by the expected index or rowid searches, false otherwise
+ */
+bool BugRepository::checkQueryPlans() {
+    bool ok = true;
+    for (const auto& query : BUILTIN_QUERIES) {
+        ok = checkQueryPlan(query.sql, query.expectedPlan) && ok;
+    }
+
+    // Every combination of predicates; only a filter without status, priority, time or cursor predicates may
+    // scan, and then only idx_bugs_created, which yields the order without a sort. A cursor must seek on Created.
+    const int predicates = 7;
+    for (int shape = 0; shape < (1 << predicates); shape++) {
+        BugFilter filter;
+        if (shape & 1) filter.status = Status::Open;
+        if (shape & 2) filter.priority = Priority::High;
+        if (shape & 4) filter.sinceMs = 0;
+        if (shape & 8) filter.untilMs = 0;
+        if (shape & 16) filter.titlePrefix = "a";
+        if (shape & 32) filter.after = FilterCursor{ 0, 1 };
+        if (shape & 64) filter.limit = 1;
+        const char* expectedPlan = filter.after ? "Created>?" :
+            (shape & 15) != 0 ? nullptr : "SCAN bugs USING INDEX idx_bugs_created";
+        string sql = filterQuery(filter);
+        ok = checkQueryPlan(sql, expectedPlan) && ok;
+
+        sqlite3_stmt* stmt;
+        string explain = "EXPLAIN QUERY PLAN " + sql;
+        if (sqlite3_prepare_v2(db, explain.c_str(), -1, &stmt, nullptr) == SQLITE_OK) {
+            while (sqlite3_step(stmt) == SQLITE_ROW) {
+                string detail = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
+                if (detail.find("TEMP B-TREE") != string::npos) {
+                    cerr << "Filtered listing sorts instead of streaming: " << sql << "\n  " << detail << endl;
+                    ok = false;
+                }
+            }
+            sqlite3_finalize(stmt);
+        }
+    }
+    return ok;
+}
+
+/**
+ * Checks the plan of one query
+ * @param sql The query
+ * @param expectedPlan Substring required in the plan, nullptr if only full scans are rejected
+ * @return true if the plan has no full scan other than the expected one and contains the expected plan
+ */
+bool BugRepository::checkQueryPlan(const string& sql, const char* expectedPlan) {
+    sqlite3_stmt* stmt;
+    string explain = "EXPLAIN QUERY PLAN " + sql;
+    if (sqlite3_prepare_v2(db, explain.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+        cerr << "Query plan check failed to prepare: " << sql << "\n  " << sqlite3_errmsg(db) << endl;
+        return false;
+    }
+    bool ok = true;
+    bool foundExpected = expectedPlan == nullptr;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        string detail = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
+        // A virtual table scan driven by an index (e.g. an FTS5 MATCH) only visits matching rows
+        bool fullScan = detail.compare(0, 5, "SCAN ") == 0 && detail != "SCAN CONSTANT ROW" &&
+            detail.find(" VIRTUAL TABLE INDEX ") == string::npos;
+        bool expected = expectedPlan && detail.find(expectedPlan) != string::npos;
+        if (fullScan && !expected) {
+            cerr << "Full scan in built-in query: " << sql << "\n  " << detail << endl;
+            ok = false;
+        }
+        if (expected) {
+            foundExpected = true;
+        }
+    }
+    sqlite3_finalize(stmt);
+    if (!foundExpected) {
+        cerr << "Built-in query does not use " << expectedPlan << ": " << sql << endl;
+        ok = false;
+    }
+    return ok;
+}
+
+/**
+ * Decodes the current row of a bug query (ID, Title, Description, Status, Priority, Created, Updated) in place
+ * Text is read with its length straight from SQLite's row buffer, so nothing is allocated or copied.
+ * @param stmt A statement positioned on a row
+ * @return A view of the row, valid until the statement is stepped, reset or finalized
+ */
+BugView readBugView(sqlite3_stmt* stmt) {
+    auto text = [stmt](int column) {
+        const unsigned char* value = sqlite3_column_text(stmt, column);
+        return value ? string_view(reinterpret_cast<const char*>(value), sqlite3_column_bytes(stmt, column)) : string_view();
+    };
+    BugView view;
+    view.id.value = sqlite3_column_int64(stmt, 0);
+    view.title = text(1);
+    view.description = text(2);
+    view.status = static_cast<Status>(sqlite3_column_int(stmt, 3));
+    view.priority = static_cast<Priority>(sqlite3_column_int(stmt, 4));
+    view.created = sqlite3_column_int64(stmt, 5);
+    view.updated = sqlite3_column_int64(stmt, 6);
+    return view;
+}
+
+/**
+ * Reads the current row of a bug query into a Bug
+ * @param stmt A statement positioned on a row
+ * @param bug Receives the row
+ */
+static void readBug(sqlite3_stmt* stmt, Bug& bug) {
+    assignBug(bug, readBugView(stmt));
+}
+
+/**
+ * Inserts a bug row, its full-text index entry, its share of bug_counts and its filing event
+ * @param bug A validated bug
+ * @return The ID assigned to the bug, or nothing if any of the statements failed
+ */
+optional<BugId> BugRepository::insertBug(const NewBug& bug) {
+    CachedStatement stmt = statement(SQL_INSERT_BUG);
+    CachedStatement index = statement(SQL_INDEX_BUG);
+    CachedStatement count = statement(SQL_COUNT_NEW_BUG);
+    CachedStatement event = statement(SQL_RECORD_FILED);
+    if (!stmt || !index || !count || !event) {
+        return nullopt;
+    }
+
+    // The strings outlive the steps below, so SQLite does not need its own copy
+    sqlite3_bind_text(stmt, 1, bug.title.data(), static_cast<int>(bug.title.size()), SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 2, bug.description.data(), static_cast<int>(bug.description.size()), SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 3, static_cast<int>(bug.priority));
+    sqlite3_int64 now = currentTimeMs();
+    sqlite3_bind_int64(stmt, 4, now);
+
+    int rc = sqlite3_step(stmt);
+    if (rc != SQLITE_DONE) {
+        cerr << "Failed to insert bug: " << sqlite3_errmsg(db) << endl;
+        return nullopt;
+    }
+    BugId id{ sqlite3_last_insert_rowid(db) };
+
+    sqlite3_bind_int64(index, 1, id.value);
+    sqlite3_bind_text(index, 2, bug.title.data(), static_cast<int>(bug.title.size()), SQLITE_STATIC);
+    sqlite3_bind_text(index, 3, bug.description.data(), static_cast<int>(bug.description.size()), SQLITE_STATIC);
+    if (sqlite3_step(index) != SQLITE_DONE) {
+        cerr << "Failed to index bug: " << sqlite3_errmsg(db) << endl;
+        return nullopt;
+    }
+
+    sqlite3_bind_int(count, 1, static_cast<int>(Status::Open));
+    sqlite3_bind_int(count, 2, static_cast<int>(bug.priority));
+    if (sqlite3_step(count) != SQLITE_DONE) {
+        cerr << "Failed to count bug: " << sqlite3_errmsg(db) << endl;
+        return nullopt;
+    }
+
+    sqlite3_bind_int64(event, 1, id.value);
+    sqlite3_bind_int64(event, 2, now);
+    if (sqlite3_step(event) != SQLITE_DONE) {
+        cerr << "Failed to record bug history: " << sqlite3_errmsg(db) << endl;
+        return nullopt;
+    }
+    return id;
+}
+
+/**
+ * Files a new bug and adds it to the full-text index
+ * Outside a transaction both inserts are committed together; inside one they are left to the caller's commit.
+ * @param bug The title, description and priority of the bug
+ * @return The ID assigned to the bug, or nothing if the values are invalid or the insert failed
+ */
+optional<BugId> BugRepository::add(const NewBug& bug) {
+    if (!isValidTitle(bug.title) || !isValidDescription(bug.description)) {
+        cerr << "Invalid title or description." << endl;
+        return nullopt;
+    }
+
+    bool ownTransaction = sqlite3_get_autocommit(db) != 0;
+    if (ownTransaction && !execute("BEGIN;")) {
+        return nullopt;
+    }
+    optional<BugId> id = insertBug(bug);
+    if (ownTransaction) {
+        if (!id || !execute("COMMIT;")) {
+            execute("ROLLBACK;");
+            return nullopt;
+        }
+    }
+    return id;
+}
+
+/**
+ * Looks up a single bug by ID, from the bug cache if one is set, otherwise with a rowid point lookup
+ * Inside a transaction the cache is bypassed, since the transaction may see other data than the cache holds.
+ * @param id The bug ID
+ * @return The bug, or nothing if no bug has the ID
+ */
+optional<Bug> BugRepository::get(BugId id) {
+    bool cached = cache && sqlite3_get_autocommit(db);
+    Bug bug;
+    if (cached && cache->find(id, bug)) {
+        return bug;
+    }
+    unsigned long long generation = cached ? cache->generation() : 0;
+
+    CachedStatement stmt = statement(SQL_GET_BUG);
+    if (!stmt) {
+        return nullopt;
+    }
+
+    sqlite3_bind_int64(stmt, 1, id.value);
+
+    int rc = sqlite3_step(stmt);
+    if (rc == SQLITE_ROW) {
+        readBug(stmt, bug);
+        if (cached) {
+            cache->insert(bug, generation);
+        }
+        return bug;
+    }
+    if (rc != SQLITE_DONE) {
+        cerr << "Failed to get bug: " << sqlite3_errmsg(db) << endl;
+    }
+    return nullopt;
+}
+
+/**
+ * Checks if a bug with the given ID exists in the database
+ * @param id The bug ID to check
+ * @return true if the bug exists, false otherwise
+ */
+bool BugRepository::exists(BugId id) {
+    CachedStatement stmt = statement(SQL_BUG_EXISTS);
+    if (!stmt) {
+        return false;
+    }
+
+    sqlite3_bind_int64(stmt, 1, id.value);
+    
+    bool exists = false;
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        exists = sqlite3_column_int(stmt, 0) > 0;
+    }
+    
+    return exists;
+}
+
+/**
+ * Reads one page of bugs using keyset pagination
+ * @param afterId Only bugs with an ID greater than this are returned
+ * @param pageSize Maximum number of bugs to return
+ * @param page Receives the bugs in ID order, replacing its previous contents
+ * @return Number of bugs read, or -1 on error
+ */
+int BugRepository::list(sqlite3_int64 afterId, int pageSize, vector<Bug>& page) {
+    page.clear();
+    sqlite3_int64 lastId = afterId;
+    return visitPage(afterId, pageSize, lastId, [](sqlite3_stmt* stmt, void* context) {
+        auto& bugs = *static_cast<vector<Bug>*>(context);
+        bugs.emplace_back();
+        readBug(stmt, bugs.back());
+    }, &page);
+}
+
+/**
+ * Visits one page of bugs using keyset pagination
+ * Seeks directly to the first ID after the cursor, so every page costs the same regardless of depth
+ * @param afterId Only bugs with an ID greater than this are visited
+ * @param pageSize Maximum number of bugs to visit
+ * @param lastId Receives the ID of the last bug visited, the cursor for the next page
+ * @param visit Called for every row
+ * @param context Passed through to visit
+ * @return Number of bugs visited, or -1 on error
+ */
+int BugRepository::visitPage(sqlite3_int64 afterId, int pageSize, sqlite3_int64& lastId, RowVisitor visit, void* context) {
+    CachedStatement stmt = statement(SQL_LIST_PAGE);
+    if (!stmt) {
+        return -1;
+    }
+
+    sqlite3_bind_int64(stmt, 1, afterId);
+    sqlite3_bind_int(stmt, 2, pageSize);
+
+    int count = 0;
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        lastId = sqlite3_column_int64(stmt, 0);
+        visit(stmt, context);
+        count++;
+    }
+    if (rc != SQLITE_DONE) {
+        cerr << "Failed to list bugs: " << sqlite3_errmsg(db) << endl;
+        return -1;
+    }
+    return count;
+}
+
+/**
+ * Visits the bugs in an ID range in ID order, with one statement that streams straight down the rowid b-tree
+ * @param afterId Only bugs with an ID greater than this are visited
+ * @param lastId Only bugs with an ID up to and including this are visited
+ * @param visit Called for every row, with the columns of SQL_GET_BUG
+ * @param context Passed through to visit
+ * @return Number of bugs visited, or -1 on error
+ */
+long long BugRepository::visitRange(sqlite3_int64 afterId, sqlite3_int64 lastId, RowVisitor visit, void* context) {
+    CachedStatement stmt = statement(SQL_LIST_RANGE);
+    if (!stmt) {
+        return -1;
+    }
+
+    sqlite3_bind_int64(stmt, 1, afterId);
+    sqlite3_bind_int64(stmt, 2, lastId);
+
+    long long count = 0;
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        visit(stmt, context);
+        count++;
+    }
+    if (rc != SQLITE_DONE) {
+        cerr << "Failed to list bugs: " << sqlite3_errmsg(db) << endl;
+        return -1;
+    }
+    return count;
+}
+
+/**
+ * Reads the lowest and highest bug ID, the range an export splits into shards
+ * @param firstId Receives the lowest ID, 0 if there are no bugs
+ * @param lastId Receives the highest ID, 0 if there are no bugs
+ * @return true on success, false on error
+ */
+bool BugRepository::idRange(sqlite3_int64& firstId, sqlite3_int64& lastId) {
+    CachedStatement stmt = statement(SQL_BUG_ID_RANGE);
+    if (!stmt || sqlite3_step(stmt) != SQLITE_ROW) {
+        cerr << "Failed to read the bug ID range: " << sqlite3_errmsg(db) << endl;
+        return false;
+    }
+    firstId = sqlite3_column_int64(stmt, 0);
+    lastId = sqlite3_column_int64(stmt, 1);
+    return true;
+}
+
+/**
+ * Builds the query for a filtered listing from the predicates the filter sets
+ * Values are bound as named parameters, so the text depends only on which predicates are set and every
+ * filter of the same shape reuses one cached statement. Bugs come in filing order (Created, ID), the order
+ * of idx_bugs_created and of the status and priority indexes that end in Created, so the planner can
+ * stream rows straight out of whichever index fits and never sorts.
+ * @param filter The predicates
+ * @return The SELECT statement, with the columns of SQL_GET_BUG
+ */
+string BugRepository::filterQuery(const BugFilter& filter) {
+    string sql = "SELECT ID, Title, Description, Status, Priority, Created, Updated FROM bugs";
+    const char* glue = " WHERE ";
+    auto where = [&](const char* predicate) {
+        sql += glue;
+        sql += predicate;
+        glue = " AND ";
+    };
+    if (filter.status) where("Status = :status");
+    if (filter.priority) where("Priority = :priority");
+    if (filter.sinceMs) where("Created >= :since");
+    if (filter.untilMs) where("Created < :until");
+    // A row value compares in listing order, so the index seeks straight to the cursor on Created
+    if (filter.after) where("(Created, ID) > (:afterCreated, :afterId)");
+    if (!filter.titlePrefix.empty()) where("Title LIKE :title ESCAPE '\\'");
+    sql += " ORDER BY Created, ID";
+    if (filter.limit > 0) sql += " LIMIT :limit";
+    return sql + ";";
+}
+
+/**
+ * Visits the bugs matching a filter in filing order, streaming each row from the statement as it is stepped
+ * @param filter The predicates
+ * @param visit Called with the statement positioned on each row
+ * @param context Passed through to visit
+ * @return Number of bugs visited, or -1 on error
+ */
+long long BugRepository::visitFiltered(const BugFilter& filter, RowVisitor visit, void* context) {
+    CachedStatement stmt = statement(filterQuery(filter));
+    if (!stmt) {
+        return -1;
+    }
+
+    auto bind = [&stmt](const char* name) { return sqlite3_bind_parameter_index(stmt, name); };
+    if (filter.status) sqlite3_bind_int(stmt, bind(":status"), static_cast<int>(*filter.status));
+    if (filter.priority) sqlite3_bind_int(stmt, bind(":priority"), static_cast<int>(*filter.priority));
+    if (filter.sinceMs) sqlite3_bind_int64(stmt, bind(":since"), *filter.sinceMs);
+    if (filter.untilMs) sqlite3_bind_int64(stmt, bind(":until"), *filter.untilMs);
+    if (filter.after) {
+        sqlite3_bind_int64(stmt, bind(":afterCreated"), filter.after->created);
+        sqlite3_bind_int64(stmt, bind(":afterId"), filter.after->id);
+    }
+    if (filter.limit > 0) sqlite3_bind_int64(stmt, bind(":limit"), filter.limit);
+    string pattern;
+    if (!filter.titlePrefix.empty()) {
+        for (char c : filter.titlePrefix) {
+            if (c == '%' || c == '_' || c == '\\') pattern.push_back('\\');
+            pattern.push_back(c);
+        }
+        pattern.push_back('%');
+        sqlite3_bind_text(stmt, bind(":title"), pattern.data(), static_cast<int>(pattern.size()), SQLITE_STATIC);
+    }
+
+    long long count = 0;
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        visit(stmt, context);
+        count++;
+    }
+    if (rc != SQLITE_DONE) {
+        cerr << "Failed to list bugs: " << sqlite3_errmsg(db) << endl;
+        return -1;
+    }
+    return count;
+}
+
+/**
+ * Sets the status of a bug and its Updated time using the cached UPDATE statement
+ * Runs as a single statement; a missing ID is detected from sqlite3_changes()
+ * rather than a separate existence check, so there is no window between check and write
+ * @param id The bug ID
+ * @param status The new status
+ * @return Done if the bug was updated, NotFound if no bug has the ID, Failed on error
+ */
+MutationResult BugRepository::updateStatus(BugId id, Status status) {
+    CachedStatement stmt = statement(SQL_UPDATE_STATUS);
+    if (!stmt) {
+        return MutationResult::Failed;
+    }
+
+    sqlite3_int64 now = currentTimeMs();
+    sqlite3_bind_int(stmt, 1, static_cast<int>(status));
+    sqlite3_bind_int64(stmt, 2, now);
+    sqlite3_bind_int64(stmt, 3, id.value);
+
+    int rc = sqlite3_step(stmt);
+    if (rc != SQLITE_DONE) {
+        cerr << "Failed to update bug: " << sqlite3_errmsg(db) << endl;
+        return MutationResult::Failed;
+    }
+    if (sqlite3_changes(db) == 0) {
+        return MutationResult::NotFound;
+    }
+
+    // Committed already in autocommit mode, so the cached copy can take the new status
+    if (cache && sqlite3_get_autocommit(db)) {
+        cache->updateStatus(id, status, now);
+    } else {
+        invalidateCached(id);
+    }
+    return MutationResult::Done;
+}
+
+/**
+ * Records the deletion of a bug in its history and deletes it
+ * @param id The bug ID
+ * @return Done if the bug was deleted, NotFound if no bug has the ID, Failed if either statement failed
+ */
+MutationResult BugRepository::deleteBug(BugId id) {
+    CachedStatement event = statement(SQL_RECORD_DELETED);
+    CachedStatement stmt = statement(SQL_DELETE_BUG);
+    if (!event || !stmt) {
+        return MutationResult::Failed;
+    }
+
+    // Reads the status the bug is deleted in, so it goes first; it records nothing if there is no such bug
+    sqlite3_bind_int64(event, 1, id.value);
+    sqlite3_bind_int64(event, 2, currentTimeMs());
+    if (sqlite3_step(event) != SQLITE_DONE) {
+        cerr << "Failed to record bug history: " << sqlite3_errmsg(db) << endl;
+        return MutationResult::Failed;
+    }
+
+    sqlite3_bind_int64(stmt, 1, id.value);
+    if (sqlite3_step(stmt) != SQLITE_DONE) {
+        cerr << "Failed to delete bug: " << sqlite3_errmsg(db) << endl;
+        return MutationResult::Failed;
+    }
+    return sqlite3_changes(db) == 0 ? MutationResult::NotFound : MutationResult::Done;
+}
+
+/**
+ * Removes a bug and records its deletion
+ * Outside a transaction both statements are committed together; inside one they are left to the caller's commit.
+ * A missing ID is detected from sqlite3_changes() rather than a separate existence check.
+ * @param id The bug ID
+ * @return Done if the bug was deleted, NotFound if no bug has the ID, Failed on error
+ */
+MutationResult BugRepository::remove(BugId id) {
+    bool ownTransaction = sqlite3_get_autocommit(db) != 0;
+    if (ownTransaction && !execute("BEGIN;")) {
+        return MutationResult::Failed;
+    }
+    MutationResult result = deleteBug(id);
+    if (ownTransaction) {
+        if (result == MutationResult::Failed || !execute("COMMIT;")) {
+            execute("ROLLBACK;");
+            return MutationResult::Failed;
+        }
+    }
+    if (result == MutationResult::Done) {
+        invalidateCached(id);
+    }
+    return result;
+}
+
+/**
+ * Turns free text into an FTS5 query that matches bugs containing every word
+ * Each word is quoted, so punctuation and FTS5 keywords are searched for literally;
+ * a trailing * keeps its prefix-search meaning.
+ * @param terms Words separated by whitespace, e.g. "login time*"
+ * @return The MATCH expression, empty if there are no words
+ */
+static string buildMatchQuery(const string& terms) {
+    string query;
+    size_t pos = 0;
+    while ((pos = terms.find_first_not_of(" \t\r\n", pos)) != string::npos) {
+        size_t end = terms.find_first_of(" \t\r\n", pos);
+        if (end == string::npos) end = terms.size();
+        bool prefix = terms[end - 1] == '*';
+        size_t wordEnd = prefix ? end - 1 : end;
+        if (wordEnd > pos) {
+            if (!query.empty()) query.push_back(' ');
+            query.push_back('"');
+            for (size_t i = pos; i < wordEnd; i++) {
+                if (terms[i] == '"') query.push_back('"');
+                query.push_back(terms[i]);
+            }
+            query.push_back('"');
+            if (prefix) query.push_back('*');
+        }
+        pos = end;
+    }
+    return query;
+}
+
+/**
+ * Full-text search over Title and Description, best matches first
+ * Rows have the columns ID, Title, Status, Priority and Match, a snippet of the best matching
+ * column with the matched words in [brackets].
+ * @param terms Words that must all appear, optionally ending in * for a prefix search
+ * @param limit Maximum number of bugs to return
+ * @param visit Called with the statement positioned on each row
+ * @param context Passed through to visit
+ * @return Number of rows visited, or -1 on error
+ */
+int BugRepository::search(const string& terms, int limit, RowVisitor visit, void* context) {
+    string match = buildMatchQuery(terms);
+    if (match.empty()) {
+        return 0;
+    }
+
+    CachedStatement stmt = statement(SQL_SEARCH_BUGS);
+    if (!stmt) {
+        return -1;
+    }
+
+    sqlite3_bind_text(stmt, 1, match.data(), static_cast<int>(match.size()), SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 2, limit);
+
+    int count = 0;
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        visit(stmt, context);
+        count++;
+    }
+    if (rc != SQLITE_DONE) {
+        cerr << "Failed to search bugs: " << sqlite3_errmsg(db) << endl;
+        return -1;
+    }
+    return count;
+}
+
+/**
+ * Reads (Status, Priority, count) rows into a BugCounts table; pairs without a row count as 0
+ * @param db The connection, for error messages
+ * @param stmt A statement returning Status, Priority and a count per row
+ * @param counts Receives the counts
+ * @return true on success, false on error or an out-of-range status or priority
+ */
+static bool readCounts(sqlite3* db, sqlite3_stmt* stmt, BugCounts& counts) {
+    for (auto& row : counts) {
+        row.fill(0);
+    }
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        int status = sqlite3_column_int(stmt, 0);
+        int priority = sqlite3_column_int(stmt, 1);
+        if (status < 0 || status >= static_cast<int>(counts.size()) ||
+            priority < 0 || priority >= static_cast<int>(counts[0].size())) {
+            cerr << "Unknown status " << status << " or priority " << priority << " in bug counts." << endl;
+            return false;
+        }
+        counts[status][priority] = sqlite3_column_int64(stmt, 2);
+    }
+    if (rc != SQLITE_DONE) {
+        cerr << "Failed to count bugs: " << sqlite3_errmsg(db) << endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Reads the number of bugs per status and priority from the trigger-maintained summary table
+ * Costs nine row reads however many bugs there are.
+ * @param counts Receives the counts
+ * @return true on success, false on error
+ */
+bool BugRepository::counts(BugCounts& counts) {
+    CachedStatement stmt = statement(SQL_BUG_COUNTS);
+    return stmt && readCounts(db, stmt, counts);
+}
+
+/**
+ * Counts the bugs per status and priority from scratch with a GROUP BY over the bugs table
+ * @param counts Receives the counts
+ * @return true on success, false on error
+ */
+bool BugRepository::recount(BugCounts& counts) {
+    CachedStatement stmt = statement(SQL_RECOUNT_BUGS);
+    return stmt && readCounts(db, stmt, counts);
+}
+
+/**
+ * Recomputes every count in the summary table from the bugs table
+ * Needed after bugs were inserted by anything other than add(), such as another tool.
+ * @return true on success, false on error
+ */
+bool BugRepository::rebuildCounts() {
+    return execute(SQL_REBUILD_COUNTS);
+}
+
+/**
+ * Compares the summary table with a fresh count, printing every pair that differs
+ * Both are read in one transaction, so concurrent writers cannot cause false mismatches.
+ * @return true if the summary matches the bugs table, false on a mismatch or error
+ */
+bool BugRepository::checkCounts() {
+    bool ownTransaction = sqlite3_get_autocommit(db) != 0;
+    if (ownTransaction && !execute("BEGIN;")) {
+        return false;
+    }
+    BugCounts summary;
+    BugCounts actual;
+    bool ok = counts(summary) && recount(actual);
+    if (ownTransaction) {
+        execute("COMMIT;");
+    }
+    if (!ok) {
+        return false;
+    }
+
+    for (size_t status = 0; status < summary.size(); status++) {
+        for (size_t priority = 0; priority < summary[status].size(); priority++) {
+            if (summary[status][priority] != actual[status][priority]) {
+                cerr << "Bug count mismatch for " << STATUS_NAMES[status] << "/" << PRIORITY_NAMES[priority]
+                    << ": summary " << summary[status][priority] << ", actual " << actual[status][priority] << endl;
+                ok = false;
+            }
+        }
+    }
+    return ok;
+}
+
+/**
+ * Counts the resolutions in a time window and the mean time from filing to each
+ * A bug resolved, reopened and resolved again counts once per resolution.
+ * @param fromMs Start of the window, Unix epoch milliseconds, inclusive
+ * @param toMs End of the window, exclusive
+ * @param stats Receives the count and mean
+ * @return true on success, false on error
+ */
+bool BugRepository::timeToResolve(long long fromMs, long long toMs, ResolveStats& stats) {
+    CachedStatement stmt = statement(SQL_TIME_TO_RESOLVE);
+    if (!stmt) {
+        return false;
+    }
+
+    sqlite3_bind_int64(stmt, 1, fromMs);
+    sqlite3_bind_int64(stmt, 2, toMs);
+
+    if (sqlite3_step(stmt) != SQLITE_ROW) {
+        cerr << "Failed to compute time to resolve: " << sqlite3_errmsg(db) << endl;
+        return false;
+    }
+    stats.resolved = sqlite3_column_int64(stmt, 0);
+    stats.meanMs = sqlite3_column_double(stmt, 1);
+    return true;
+}
+
+/**
+ * Groups the bugs not yet resolved (Open and In Progress) by how long ago they were filed
+ * @param nowMs The time ages are measured at, Unix epoch milliseconds
+ * @param aging Receives one entry per AGING_BUCKET_NAMES bucket
+ * @return true on success, false on error
+ */
+bool BugRepository::openBugAging(long long nowMs, BugAging& aging) {
+    CachedStatement stmt = statement(SQL_OPEN_BUG_AGING);
+    if (!stmt) {
+        return false;
+    }
+
+    sqlite3_bind_int64(stmt, 1, nowMs);
+    for (size_t i = 0; i < size(AGING_LIMITS_MS); i++) {
+        sqlite3_bind_int64(stmt, static_cast<int>(i) + 2, AGING_LIMITS_MS[i]);
+    }
+
+    aging.fill(AgingBucket());
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        int bucket = sqlite3_column_int(stmt, 0);
+        if (bucket < 0 || bucket >= static_cast<int>(aging.size())) {
+            continue;
+        }
+        aging[bucket].bugs = sqlite3_column_int64(stmt, 1);
+        aging[bucket].meanAgeMs = sqlite3_column_double(stmt, 2);
+        aging[bucket].maxAgeMs = sqlite3_column_int64(stmt, 3);
+    }
+    if (rc != SQLITE_DONE) {
+        cerr << "Failed to compute open bug aging: " << sqlite3_errmsg(db) << endl;
+        return false;
+    }
+    return true;
+}
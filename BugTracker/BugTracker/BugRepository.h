@@ -0,0 +1,252 @@
+#pragma once
+
+#include "Bug.h"
+#include "BugCache.h"
+#include <array>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * Scoped handle to a cached statement
+ * Resets the statement and clears its bindings when it goes out of scope,
+ * so the next user always receives a fresh statement and no read lock is left open
+ */
+class CachedStatement {
+public:
+    explicit CachedStatement(sqlite3_stmt* stmt) : stmt(stmt) {}
+    ~CachedStatement() {
+        if (stmt) {
+            sqlite3_reset(stmt);
+            sqlite3_clear_bindings(stmt);
+        }
+    }
+    CachedStatement(CachedStatement&& other) noexcept : stmt(other.stmt) { other.stmt = nullptr; }
+    CachedStatement(const CachedStatement&) = delete;
+    CachedStatement& operator=(const CachedStatement&) = delete;
+
+    operator sqlite3_stmt*() const { return stmt; }
+    explicit operator bool() const { return stmt != nullptr; }
+
+private:
+    sqlite3_stmt* stmt;
+};
+
+// Built-in queries, registered in BUILTIN_QUERIES so their plans can be checked
+inline constexpr const char* SQL_BUG_EXISTS = "SELECT COUNT(*) FROM bugs WHERE ID = ?;";
+inline constexpr const char* SQL_INSERT_BUG =
+    "INSERT INTO bugs (Title, Description, Priority, Created, Updated) VALUES (?1, ?2, ?3, ?4, ?4);";
+inline constexpr const char* SQL_INDEX_BUG = "INSERT INTO bugs_fts (rowid, Title, Description) VALUES (?, ?, ?);";
+inline constexpr const char* SQL_GET_BUG =
+    "SELECT ID, Title, Description, Status, Priority, Created, Updated FROM bugs WHERE ID = ?;";
+inline constexpr const char* SQL_LIST_PAGE =
+    "SELECT ID, Title, Description, Status, Priority, Created, Updated FROM bugs WHERE ID > ? ORDER BY ID LIMIT ?;";
+// Bugs with ?1 < ID <= ?2, one shard of an export
+inline constexpr const char* SQL_LIST_RANGE =
+    "SELECT ID, Title, Description, Status, Priority, Created, Updated FROM bugs "
+    "WHERE ID > ? AND ID <= ? ORDER BY ID;";
+// Lowest and highest bug ID, two seeks to the ends of the rowid b-tree (both NULL if there are no bugs)
+inline constexpr const char* SQL_BUG_ID_RANGE = "SELECT (SELECT MIN(ID) FROM bugs), (SELECT MAX(ID) FROM bugs);";
+inline constexpr const char* SQL_UPDATE_STATUS = "UPDATE bugs SET Status = ?, Updated = ? WHERE ID = ?;";
+inline constexpr const char* SQL_DELETE_BUG = "DELETE FROM bugs WHERE ID = ?;";
+inline constexpr const char* SQL_SEARCH_BUGS =
+    "SELECT bugs.ID, bugs.Title, bugs.Status, bugs.Priority, "
+    "snippet(bugs_fts, -1, '[', ']', '...', 12) AS Match "
+    "FROM bugs_fts JOIN bugs ON bugs.ID = bugs_fts.rowid "
+    "WHERE bugs_fts MATCH ? ORDER BY bugs_fts.rank LIMIT ?;";
+// Counts a bug just inserted by add(); deletes and status changes are counted by triggers
+inline constexpr const char* SQL_COUNT_NEW_BUG =
+    "UPDATE bug_counts SET Count = Count + 1 WHERE Status = ? AND Priority = ?;";
+// Reads the nine counters, independent of the number of bugs
+inline constexpr const char* SQL_BUG_COUNTS = "SELECT Status, Priority, Count FROM bug_counts;";
+// Recounts from the bugs themselves; a scan of idx_bugs_status_priority, used only to check bug_counts
+inline constexpr const char* SQL_RECOUNT_BUGS =
+    "SELECT Status, Priority, COUNT(*) FROM bugs GROUP BY Status, Priority;";
+// Records the filing of a bug just inserted by add(); status changes are recorded by a trigger
+inline constexpr const char* SQL_RECORD_FILED =
+    "INSERT INTO bug_events (BugID, Ts, OldStatus, NewStatus) "
+    "VALUES (?, ?, NULL, 0);";
+// Records the deletion of bug ?1 at ?2 by remove(), just before the delete; inserts nothing if there is no such bug
+inline constexpr const char* SQL_RECORD_DELETED =
+    "INSERT INTO bug_events (BugID, Ts, OldStatus, NewStatus) "
+    "SELECT ID, ?2, Status, NULL FROM bugs WHERE ID = ?1;";
+// Resolutions in [?1, ?2) and the mean time from filing to each: a range of idx_bug_events_status,
+// with the filing time of each bug found by one seek into idx_bug_events_bug
+inline constexpr const char* SQL_TIME_TO_RESOLVE =
+    "SELECT COUNT(*), AVG(resolved.Ts - (SELECT MIN(filed.Ts) FROM bug_events AS filed "
+    "WHERE filed.BugID = resolved.BugID)) "
+    "FROM bug_events AS resolved WHERE resolved.NewStatus = 2 AND resolved.Ts >= ?1 AND resolved.Ts < ?2;";
+// Bugs not yet resolved grouped by age at ?1 (epoch ms) into buckets bounded by ?2 < ?3 < ?4 milliseconds:
+// a range of idx_bugs_status_created, which carries Created, so no bug row is read
+inline constexpr const char* SQL_OPEN_BUG_AGING =
+    "SELECT CASE WHEN Age < ?2 THEN 0 WHEN Age < ?3 THEN 1 WHEN Age < ?4 THEN 2 ELSE 3 END AS Bucket, "
+    "COUNT(*), AVG(Age), MAX(Age) "
+    "FROM (SELECT ?1 - Created AS Age FROM bugs WHERE Status < 2) "
+    "GROUP BY Bucket ORDER BY Bucket;";
+inline constexpr const char* SQL_REBUILD_COUNTS =
+    "UPDATE bug_counts SET Count = (SELECT COUNT(*) FROM bugs "
+    "WHERE bugs.Status = bug_counts.Status AND bugs.Priority = bug_counts.Priority);";
+
+/**
+ * Connection settings applied with PRAGMA statements when the database is opened
+ */
+struct PragmaProfile {
+    std::string journalMode;    // DELETE, TRUNCATE, PERSIST, MEMORY, WAL or OFF
+    std::string synchronous;    // OFF, NORMAL, FULL or EXTRA
+    long long cacheSize;        // Pages if positive, KiB if negative
+    long long mmapSize;         // Bytes of the file mapped into memory, 0 disables mmap
+    std::string tempStore;      // DEFAULT, FILE or MEMORY
+};
+
+/**
+ * Named connection presets selectable with --profile
+ *   durable  - WAL with a sync on every commit; no committed transaction is ever lost
+ *   balanced - WAL syncing only at checkpoints; the last commits may roll back after a power loss
+ *   fast     - no syncing at all; the database may be corrupted by an OS crash or power loss
+ *   legacy   - SQLite defaults (rollback journal, synchronous=FULL), the behavior before profiles existed
+ */
+inline const std::pair<const char*, PragmaProfile> PRAGMA_PROFILES[] = {
+    { "durable",  { "WAL",    "FULL",   -8192,  0,           "DEFAULT" } },
+    { "balanced", { "WAL",    "NORMAL", -16384, 268435456,   "MEMORY" } },
+    { "fast",     { "WAL",    "OFF",    -65536, 1073741824,  "MEMORY" } },
+    { "legacy",   { "DELETE", "FULL",   -2000,  0,           "DEFAULT" } },
+};
+
+// Profile used when --profile is not given
+inline constexpr const char* DEFAULT_PRAGMA_PROFILE = "durable";
+
+bool findPragmaProfile(const std::string& name, PragmaProfile& profile);
+bool isAllowedKeyword(std::string& value, const std::vector<std::string>& allowed);
+
+/**
+ * Outcome of a single-row UPDATE or DELETE
+ */
+enum class MutationResult {
+    Done,
+    NotFound,
+    Failed
+};
+
+// Number of bugs per status and priority, indexed by the stored integer values: counts[status][priority]
+typedef std::array<std::array<long long, std::size(PRIORITY_NAMES)>, std::size(STATUS_NAMES)> BugCounts;
+
+/**
+ * Resolutions in a time window and their mean time from filing
+ */
+struct ResolveStats {
+    long long resolved = 0;
+    double meanMs = 0;      // 0 if nothing was resolved
+};
+
+// Upper age limits of the open-bug aging buckets; the last bucket holds everything older
+inline constexpr long long AGING_LIMITS_MS[] = { 86400000LL, 7 * 86400000LL, 30 * 86400000LL };
+inline constexpr const char* AGING_BUCKET_NAMES[] = { "< 1 day", "1-7 days", "7-30 days", "> 30 days" };
+
+/**
+ * Bugs not yet resolved whose age falls in one aging bucket
+ */
+struct AgingBucket {
+    long long bugs = 0;
+    double meanAgeMs = 0;
+    long long maxAgeMs = 0;
+};
+
+typedef std::array<AgingBucket, std::size(AGING_BUCKET_NAMES)> BugAging;
+
+/**
+ * A position in filing order: the Created time and ID of a bug, e.g. the last bug of the previous page
+ */
+struct FilterCursor {
+    sqlite3_int64 created = 0;
+    sqlite3_int64 id = 0;
+};
+
+/**
+ * Predicates of a filtered listing; a predicate left unset matches every bug
+ * Filters that set the same predicates share one query text and so one cached statement.
+ */
+struct BugFilter {
+    std::optional<Status> status;
+    std::optional<Priority> priority;
+    std::optional<sqlite3_int64> sinceMs;   // Filed at or after, Unix epoch milliseconds
+    std::optional<sqlite3_int64> untilMs;   // Filed before
+    std::string titlePrefix;                // Case-insensitive for ASCII letters; empty matches every title
+    std::optional<FilterCursor> after;      // Only bugs that come after this position in filing order
+    long long limit = 0;                    // Largest number of bugs, 0 for no limit
+};
+
+// Called by BugRepository::visitPage() for every row, with the statement positioned on the row
+typedef void (*RowVisitor)(sqlite3_stmt* stmt, void* context);
+
+// Decodes a row of SQL_GET_BUG, SQL_LIST_PAGE, SQL_LIST_RANGE or a filter query without copying; see BugView
+BugView readBugView(sqlite3_stmt* stmt);
+
+/**
+ * Owns one SQLite connection to a bugs database and its prepared statement cache
+ * Every operation takes and returns typed values and never touches the console,
+ * so the same repository serves the interactive menu, batch jobs and benchmarks.
+ * A repository must only be used by one thread at a time; give each thread its own.
+ * Repositories may share a BugCache, which then serves get() outside transactions.
+ */
+class BugRepository {
+public:
+    BugRepository() = default;
+    ~BugRepository();
+    BugRepository(const BugRepository&) = delete;
+    BugRepository& operator=(const BugRepository&) = delete;
+
+    // Connection
+    bool open(const std::string& path, const PragmaProfile& profile);
+    bool openReadOnly(const std::string& path, const PragmaProfile& profile);
+    void close();
+    bool isOpen() const { return db != nullptr; }
+    sqlite3* connection() const { return db; }
+    void setCache(BugCache* cache);
+
+    // Bug operations
+    std::optional<BugId> add(const NewBug& bug);
+    std::optional<Bug> get(BugId id);
+    bool exists(BugId id);
+    int list(sqlite3_int64 afterId, int pageSize, std::vector<Bug>& page);
+    int visitPage(sqlite3_int64 afterId, int pageSize, sqlite3_int64& lastId, RowVisitor visit, void* context);
+    long long visitFiltered(const BugFilter& filter, RowVisitor visit, void* context);
+    long long visitRange(sqlite3_int64 afterId, sqlite3_int64 lastId, RowVisitor visit, void* context);
+    bool idRange(sqlite3_int64& firstId, sqlite3_int64& lastId);
+    MutationResult updateStatus(BugId id, Status status);
+    MutationResult remove(BugId id);
+    int search(const std::string& terms, int limit, RowVisitor visit, void* context);
+    bool counts(BugCounts& counts);
+    bool recount(BugCounts& counts);
+    bool rebuildCounts();
+    bool timeToResolve(long long fromMs, long long toMs, ResolveStats& stats);
+    bool openBugAging(long long nowMs, BugAging& aging);
+    bool checkCounts();
+
+    // Statements and maintenance
+    bool execute(const std::string& sql);
+    CachedStatement statement(const std::string& sql);
+    bool checkQueryPlans();
+    static std::string filterQuery(const BugFilter& filter);
+    void printStatementCacheStats() const;
+
+private:
+    std::optional<BugId> insertBug(const NewBug& bug);
+    MutationResult deleteBug(BugId id);
+    bool applyPragmaProfile(const PragmaProfile& profile);
+    int schemaVersion();
+    bool migrateSchema();
+    bool checkQueryPlan(const std::string& sql, const char* expectedPlan);
+    void clearStatementCache();
+    void invalidateCached(BugId id);
+    void flushCacheInvalidations();
+
+    sqlite3* db = nullptr;
+    BugCache* cache = nullptr;
+    std::vector<BugId> uncommittedChanges;  // Bugs changed in the open transaction, dropped from the cache when it ends
+    std::unordered_map<std::string, sqlite3_stmt*> statements;
+    unsigned long long cacheHits = 0;
+    unsigned long long cacheMisses = 0;
+};
@@ -0,0 +1,185 @@
+#include "Export.h"
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <cstdio>
+#include <functional>
+#include <filesystem>
+#ifdef BUGTRACKER_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+using namespace std;
+
+// How long an export waits for another writer's transaction to end before it gives up on taking its snapshot
+const int EXPORT_LOCK_TIMEOUT_MS = 30000;
+
+#ifdef BUGTRACKER_HAVE_ZLIB
+/**
+ * Stream buffer that gzip-compresses everything written to it into a file
+ * It has no put area, so every write of OutputWriter's buffer goes to gzwrite() in one piece.
+ */
+class GzipFileBuf : public streambuf {
+public:
+    ~GzipFileBuf() { close(); }
+
+    bool open(const string& path) {
+        // Level 1: deflate dominates an export, and the default level 6 takes twice as long for files ~10% smaller
+        file = gzopen(path.c_str(), "wb1");
+        return file != nullptr;
+    }
+
+    bool close() {
+        if (!file) {
+            return true;
+        }
+        bool ok = gzclose(file) == Z_OK;
+        file = nullptr;
+        return ok;
+    }
+
+protected:
+    streamsize xsputn(const char* data, streamsize size) override {
+        return file && gzwrite(file, data, static_cast<unsigned>(size)) == size ? size : 0;
+    }
+
+    int overflow(int c) override {
+        if (c == traits_type::eof()) return traits_type::not_eof(c);
+        return file && gzputc(file, c) != -1 ? c : traits_type::eof();
+    }
+
+private:
+    gzFile file = nullptr;
+};
+#endif
+
+/**
+ * One shard of an export: a slice of the ID range, read on its own connection and written to its own file
+ */
+struct ExportShard {
+    BugRepository repository;
+    sqlite3_int64 afterId = 0;  // Bugs with afterId < ID <= lastId
+    sqlite3_int64 lastId = 0;
+    string path;
+    long long rows = 0;
+    bool ok = false;
+};
+
+/**
+ * Writes the bugs of one shard to its file and ends the shard's read transaction; runs on its own thread
+ * @param shard A shard whose connection is inside the export's read transaction
+ * @param format csv or ndjson
+ */
+void writeExportShard(ExportShard& shard, OutputFormat format) {
+#ifdef BUGTRACKER_HAVE_ZLIB
+    GzipFileBuf file;
+    bool opened = file.open(shard.path);
+    ostream out(&file);
+#else
+    ofstream out(shard.path, ios::binary);
+    bool opened = out.is_open();
+#endif
+    if (!opened) {
+        cerr << "Can't create " << shard.path << endl;
+        shard.repository.execute("ROLLBACK;");
+        return;
+    }
+
+    OutputWriter writer(out);
+    writer.setFormat(format);
+    writer.beginResult();
+    shard.rows = shard.repository.visitRange(shard.afterId, shard.lastId, writeRowVisitor, &writer);
+    writer.flush();
+    shard.repository.execute("ROLLBACK;");
+
+#ifdef BUGTRACKER_HAVE_ZLIB
+    bool written = out.good() && file.close();
+#else
+    out.close();
+    bool written = out.good();
+#endif
+    if (!written) {
+        cerr << "Failed to write " << shard.path << endl;
+    }
+    shard.ok = shard.rows >= 0 && written;
+}
+
+/**
+ * Writes every bug to one file per thread in parallel
+ * The ID range is split into equal slices, each read in ID order on its own read-only connection by its
+ * own thread and written as csv or ndjson (gzip-compressed when built with zlib) to bugs-<n> in the directory.
+ * All shards see the same committed state: while this connection holds the write lock, so that nothing
+ * can commit, every shard connection starts its read transaction, and only then is the lock released.
+ * In WAL mode writers carry on during the export; with a rollback journal they wait until it finishes.
+ * @param repository The open bug repository, outside any transaction
+ * @param directory An existing directory for the files
+ * @param threads Number of threads and files
+ * @param format csv or ndjson
+ * @param profile Connection settings for the shard connections
+ * @param rows Receives the number of bugs exported
+ * @return true if every shard was written, false otherwise
+ */
+bool exportBugs(BugRepository& repository, const string& directory, int threads, OutputFormat format,
+    const PragmaProfile& profile, long long& rows) {
+    string databasePath = sqlite3_db_filename(repository.connection(), "main");
+    const char* extension = format == OutputFormat::Csv ? ".csv" : ".ndjson";
+#ifdef BUGTRACKER_HAVE_ZLIB
+    const char* compression = ".gz";
+#else
+    const char* compression = "";
+#endif
+
+    // Connections are opened first, so the write lock below is only held while the snapshots are taken
+    vector<ExportShard> shards(threads);  // Never resized, so the repositories stay in place
+    for (ExportShard& shard : shards) {
+        if (!shard.repository.openReadOnly(databasePath, profile)) {
+            return false;
+        }
+    }
+
+    sqlite3_busy_timeout(repository.connection(), EXPORT_LOCK_TIMEOUT_MS);
+    bool locked = repository.execute("BEGIN IMMEDIATE;");
+    sqlite3_busy_timeout(repository.connection(), 0);
+    if (!locked) {
+        return false;
+    }
+    sqlite3_int64 firstId;
+    sqlite3_int64 lastId;
+    bool ready = repository.idRange(firstId, lastId);
+    for (ExportShard& shard : shards) {
+        // The first read starts the transaction, and with it the snapshot
+        sqlite3_int64 first;
+        sqlite3_int64 last;
+        ready = ready && shard.repository.execute("BEGIN;") && shard.repository.idRange(first, last);
+    }
+    repository.execute("ROLLBACK;");
+    if (!ready) {
+        return false;
+    }
+
+    sqlite3_int64 span = lastId > 0 ? (lastId - firstId) / threads + 1 : 0;
+    for (int i = 0; i < threads; i++) {
+        ExportShard& shard = shards[i];
+        shard.afterId = firstId - 1 + min(lastId - firstId + 1, span * i);
+        shard.lastId = i + 1 == threads ? lastId : firstId - 1 + min(lastId - firstId + 1, span * (i + 1));
+        char name[32];
+        snprintf(name, sizeof(name), "bugs-%03d", i);
+        shard.path = (filesystem::path(directory) / (name + string(extension) + compression)).string();
+    }
+
+    vector<thread> workers;
+    for (ExportShard& shard : shards) {
+        workers.emplace_back(writeExportShard, ref(shard), format);
+    }
+    rows = 0;
+    bool ok = true;
+    for (size_t i = 0; i < workers.size(); i++) {
+        workers[i].join();
+        rows += shards[i].rows;
+        ok = ok && shards[i].ok;
+    }
+    return ok;
+}
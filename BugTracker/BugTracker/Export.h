@@ -0,0 +1,11 @@
+#pragma once
+
+#include "BugRepository.h"
+#include "OutputWriter.h"
+#include <string>
+
+// Most threads, and so shard files, an export may use
+inline constexpr int MAX_EXPORT_THREADS = 256;
+
+bool exportBugs(BugRepository& repository, const std::string& directory, int threads, OutputFormat format,
+    const PragmaProfile& profile, long long& rows);
@@ -0,0 +1,936 @@
+#include "HttpServer.h"
+#include "Json.h"
+#include "Socket.h"
+#include "WriteQueue.h"
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <charconv>
+#include <condition_variable>
+#include <csignal>
+#include <mutex>
+#include <thread>
+
+using namespace std;
+
+// Largest accepted request line plus headers
+const size_t MAX_REQUEST_HEAD = 16 * 1024;
+
+// Largest accepted request body
+const size_t MAX_REQUEST_BODY = 1024 * 1024;
+
+// Keep-alive connections with no traffic for this long are closed
+const chrono::seconds KEEP_ALIVE_TIMEOUT(30);
+
+// Longest the acceptor sleeps before checking for shutdown and idle connections
+const int POLL_INTERVAL_MS = 250;
+
+// Page size of GET /bugs when no limit is given, and the largest limit accepted
+const int DEFAULT_PAGE_LIMIT = 20;
+const int MAX_PAGE_LIMIT = 1000;
+
+// How long a worker waits for another worker's write transaction before failing a request
+const int BUSY_TIMEOUT_MS = 5000;
+
+// Set by SIGINT or SIGTERM; the acceptor notices it within POLL_INTERVAL_MS
+static volatile sig_atomic_t stopRequested = 0;
+
+static void requestStop(int) {
+    stopRequested = 1;
+}
+
+/**
+ * A parsed HTTP/1.x request
+ */
+struct HttpRequest {
+    string method;
+    string target;      // Path and query string
+    string body;
+    bool keepAlive = true;
+};
+
+/**
+ * Outcome of trying to parse a request from the bytes received so far
+ */
+enum class ParseResult {
+    Incomplete,
+    Complete,
+    Invalid,
+    TooLarge
+};
+
+/**
+ * A client connection, owned by the acceptor while idle and by one worker while a request is served
+ */
+struct Connection {
+    explicit Connection(socket_t socket) : socket(socket), lastActive(chrono::steady_clock::now()) {}
+    ~Connection() { closeSocket(socket); }
+    Connection(const Connection&) = delete;
+    Connection& operator=(const Connection&) = delete;
+
+    socket_t socket;
+    string input;                   // Received bytes not yet consumed by a request
+    HttpRequest request;            // The request being served, filled by parseRequest()
+    chrono::steady_clock::time_point lastActive;
+};
+
+/**
+ * Per-thread state of a worker: its own database connection and reusable buffers
+ */
+struct Worker {
+    BugRepository repository;
+    WriteQueue* writes = nullptr;   // Shared group-commit queue with --group-commit, otherwise null
+    const BugCache* cache = nullptr;  // Shared bug cache, null if disabled
+    string body;
+    string response;
+};
+
+/**
+ * Compares two strings ignoring ASCII case
+ */
+static bool equalsIgnoreCase(string_view a, string_view b) {
+    return a.size() == b.size() && equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+        return tolower(static_cast<unsigned char>(x)) == tolower(static_cast<unsigned char>(y));
+    });
+}
+
+/**
+ * Removes leading and trailing spaces and tabs
+ */
+static string_view trim(string_view text) {
+    size_t start = text.find_first_not_of(" \t");
+    if (start == string_view::npos) {
+        return string_view();
+    }
+    size_t end = text.find_last_not_of(" \t");
+    return text.substr(start, end - start + 1);
+}
+
+/**
+ * Parses the first complete request buffered on a connection and consumes its bytes
+ * Bodies must be sent with Content-Length; chunked transfer encoding is rejected.
+ * @param connection The connection whose input is parsed; its request is replaced on success
+ * @return Complete if a request was parsed, Incomplete if more bytes are needed, otherwise the error
+ */
+static ParseResult parseRequest(Connection& connection) {
+    const string& input = connection.input;
+    size_t headEnd = input.find("\r\n\r\n");
+    if (headEnd == string::npos) {
+        return input.size() > MAX_REQUEST_HEAD ? ParseResult::TooLarge : ParseResult::Incomplete;
+    }
+    if (headEnd > MAX_REQUEST_HEAD) {
+        return ParseResult::TooLarge;
+    }
+
+    string_view head(input.data(), headEnd);
+    size_t lineEnd = head.find("\r\n");
+    string_view requestLine = head.substr(0, lineEnd);
+    size_t firstSpace = requestLine.find(' ');
+    size_t secondSpace = requestLine.find(' ', firstSpace + 1);
+    if (firstSpace == string_view::npos || secondSpace == string_view::npos) {
+        return ParseResult::Invalid;
+    }
+
+    HttpRequest& request = connection.request;
+    request.method.assign(requestLine.substr(0, firstSpace));
+    request.target.assign(requestLine.substr(firstSpace + 1, secondSpace - firstSpace - 1));
+    string_view version = requestLine.substr(secondSpace + 1);
+    if (version == "HTTP/1.1") request.keepAlive = true;
+    else if (version == "HTTP/1.0") request.keepAlive = false;
+    else return ParseResult::Invalid;
+
+    size_t contentLength = 0;
+    size_t pos = lineEnd == string_view::npos ? head.size() : lineEnd + 2;
+    while (pos < head.size()) {
+        size_t end = head.find("\r\n", pos);
+        if (end == string_view::npos) end = head.size();
+        string_view line = head.substr(pos, end - pos);
+        pos = end + 2;
+
+        size_t colon = line.find(':');
+        if (colon == string_view::npos) {
+            return ParseResult::Invalid;
+        }
+        string_view name = line.substr(0, colon);
+        string_view value = trim(line.substr(colon + 1));
+        if (equalsIgnoreCase(name, "Content-Length")) {
+            auto result = from_chars(value.data(), value.data() + value.size(), contentLength);
+            if (result.ec != errc() || result.ptr != value.data() + value.size()) {
+                return ParseResult::Invalid;
+            }
+            if (contentLength > MAX_REQUEST_BODY) {
+                return ParseResult::TooLarge;
+            }
+        } else if (equalsIgnoreCase(name, "Connection")) {
+            if (equalsIgnoreCase(value, "close")) request.keepAlive = false;
+            else if (equalsIgnoreCase(value, "keep-alive")) request.keepAlive = true;
+        } else if (equalsIgnoreCase(name, "Transfer-Encoding")) {
+            return ParseResult::Invalid;
+        }
+    }
+
+    size_t bodyStart = headEnd + 4;
+    if (input.size() < bodyStart + contentLength) {
+        return ParseResult::Incomplete;
+    }
+    request.body.assign(input, bodyStart, contentLength);
+    connection.input.erase(0, bodyStart + contentLength);
+    return ParseResult::Complete;
+}
+
+/**
+ * Returns the reason phrase of the status codes the server sends
+ */
+static const char* statusText(int status) {
+    switch (status) {
+    case 200: return "OK";
+    case 201: return "Created";
+    case 204: return "No Content";
+    case 400: return "Bad Request";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 413: return "Payload Too Large";
+    case 500: return "Internal Server Error";
+    default: return "Unknown";
+    }
+}
+
+/**
+ * Formats a complete response with a JSON body
+ * @param response Receives the status line, headers and body
+ * @param status HTTP status code
+ * @param body JSON body, empty for 204
+ * @param keepAlive Whether the connection stays open after the response
+ */
+static void formatResponse(string& response, int status, const string& body, bool keepAlive) {
+    response.clear();
+    response.append("HTTP/1.1 ");
+    response.append(to_string(status));
+    response.push_back(' ');
+    response.append(statusText(status));
+    response.append("\r\nContent-Type: application/json\r\nContent-Length: ");
+    response.append(to_string(body.size()));
+    response.append(keepAlive ? "\r\nConnection: keep-alive\r\n\r\n" : "\r\nConnection: close\r\n\r\n");
+    response.append(body);
+}
+
+/**
+ * Writes a JSON error body and returns the status code, for use as "return error(...)"
+ */
+static int error(string& body, int status, string_view message) {
+    body.assign("{\"error\":");
+    appendJsonString(body, message);
+    body.push_back('}');
+    return status;
+}
+
+/**
+ * Appends a bug as a JSON object
+ */
+static void appendBugJson(string& out, const BugView& bug) {
+    out.append("{\"id\":");
+    out.append(to_string(bug.id.value));
+    out.append(",\"title\":");
+    appendJsonString(out, bug.title);
+    out.append(",\"description\":");
+    appendJsonString(out, bug.description);
+    out.append(",\"status\":");
+    appendJsonString(out, STATUS_NAMES[static_cast<int>(bug.status)]);
+    out.append(",\"priority\":");
+    appendJsonString(out, PRIORITY_NAMES[static_cast<int>(bug.priority)]);
+    out.append(",\"created\":");
+    out.append(to_string(bug.created));
+    out.append(",\"updated\":");
+    out.append(to_string(bug.updated));
+    out.push_back('}');
+}
+
+/**
+ * Looks up a value in a flat JSON object by key, ignoring case as the importer does
+ * @return The value, or nullptr if the key is absent
+ */
+static const string* findField(const JsonFields& fields, string_view key) {
+    for (const auto& field : fields) {
+        if (equalsIgnoreCase(field.first, key)) {
+            return &field.second;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * Reads a non-negative integer query parameter
+ * @param query The query string without the leading '?'
+ * @param name Parameter name
+ * @param value Receives the value if the parameter is present
+ * @return false if the parameter is present but not a non-negative integer, true otherwise
+ */
+static bool queryParameter(string_view query, string_view name, long long& value) {
+    while (!query.empty()) {
+        size_t end = query.find('&');
+        string_view pair = query.substr(0, end);
+        query = end == string_view::npos ? string_view() : query.substr(end + 1);
+
+        size_t equals = pair.find('=');
+        if (equals == string_view::npos || pair.substr(0, equals) != name) {
+            continue;
+        }
+        string_view text = pair.substr(equals + 1);
+        auto result = from_chars(text.data(), text.data() + text.size(), value);
+        return result.ec == errc() && result.ptr == text.data() + text.size() && value >= 0;
+    }
+    return true;
+}
+
+/**
+ * GET /bugs?after=<id>&limit=<n>: one page of bugs in ID order
+ * The response carries the cursor for the next page in "next", or null after the last page.
+ */
+static int handleList(Worker& worker, string_view query) {
+    long long after = 0;
+    long long limit = DEFAULT_PAGE_LIMIT;
+    if (!queryParameter(query, "after", after) || !queryParameter(query, "limit", limit) ||
+        limit == 0 || limit > MAX_PAGE_LIMIT) {
+        return error(worker.body, 400, "after must be a bug ID and limit between 1 and 1000");
+    }
+
+    // Rows are written straight from SQLite's buffers as they are stepped, without copying them into Bugs first
+    string& body = worker.body;
+    body.assign("{\"bugs\":[");
+    sqlite3_int64 lastId = after;
+    int count = worker.repository.visitPage(after, static_cast<int>(limit), lastId, [](sqlite3_stmt* stmt, void* context) {
+        string& out = *static_cast<string*>(context);
+        if (out.back() != '[') out.push_back(',');
+        appendBugJson(out, readBugView(stmt));
+    }, &body);
+    if (count < 0) {
+        return error(worker.body, 500, "Database error");
+    }
+    body.append("],\"next\":");
+    body.append(count == limit ? to_string(lastId) : "null");
+    body.push_back('}');
+    return 200;
+}
+
+/**
+ * POST /bugs with {"title", "description", "priority"}: files a new bug
+ */
+static int handleAdd(Worker& worker, const string& requestBody) {
+    JsonFields fields;
+    if (!parseJsonObject(requestBody, fields)) {
+        return error(worker.body, 400, "Request body must be a flat JSON object");
+    }
+    const string* title = findField(fields, "title");
+    const string* description = findField(fields, "description");
+    const string* priority = findField(fields, "priority");
+
+    NewBug bug{ title ? *title : string(), description ? *description : string(), Priority::Low };
+    if (!isValidTitle(bug.title)) {
+        return error(worker.body, 400, "Title must not be empty and must be less than 100 characters");
+    }
+    if (!isValidDescription(bug.description)) {
+        return error(worker.body, 400, "Description must not be empty and must be less than 1000 characters");
+    }
+    if (!priority || !parsePriority(*priority, bug.priority)) {
+        return error(worker.body, 400, "Priority must be Low, Medium or High");
+    }
+
+    // With group commit, concurrent submissions share one transaction and one fsync
+    optional<BugId> id = worker.writes ? worker.writes->submit(move(bug)).get() : worker.repository.add(bug);
+    if (!id) {
+        return error(worker.body, 500, "Database error");
+    }
+    worker.body.assign("{\"id\":");
+    worker.body.append(to_string(id->value));
+    worker.body.push_back('}');
+    return 201;
+}
+
+/**
+ * PATCH or PUT /bugs/<id> with {"status"}: changes the status of a bug
+ */
+static int handleUpdate(Worker& worker, BugId id, const string& requestBody) {
+    JsonFields fields;
+    if (!parseJsonObject(requestBody, fields)) {
+        return error(worker.body, 400, "Request body must be a flat JSON object");
+    }
+    const string* name = findField(fields, "status");
+    Status status;
+    if (!name || !parseStatus(*name, status)) {
+        return error(worker.body, 400, "Status must be Open, In Progress or Resolved");
+    }
+
+    MutationResult result = worker.writes ? worker.writes->submitStatus(id, status).get()
+        : worker.repository.updateStatus(id, status);
+    switch (result) {
+    case MutationResult::Done:
+        worker.body.assign("{\"id\":");
+        worker.body.append(to_string(id.value));
+        worker.body.append(",\"status\":");
+        appendJsonString(worker.body, STATUS_NAMES[static_cast<int>(status)]);
+        worker.body.push_back('}');
+        return 200;
+    case MutationResult::NotFound:
+        return error(worker.body, 404, "No bug has this ID");
+    default:
+        return error(worker.body, 500, "Database error");
+    }
+}
+
+/**
+ * GET /stats: bug counts per status and priority, read from the summary table
+ */
+static int handleStats(Worker& worker) {
+    BugCounts counts;
+    if (!worker.repository.counts(counts)) {
+        return error(worker.body, 500, "Database error");
+    }
+    long long total = 0;
+    worker.body.push_back('{');
+    for (size_t status = 0; status < counts.size(); status++) {
+        appendJsonString(worker.body, STATUS_NAMES[status]);
+        worker.body.append(":{");
+        for (size_t priority = 0; priority < counts[status].size(); priority++) {
+            if (priority) worker.body.push_back(',');
+            appendJsonString(worker.body, PRIORITY_NAMES[priority]);
+            worker.body.push_back(':');
+            worker.body.append(to_string(counts[status][priority]));
+            total += counts[status][priority];
+        }
+        worker.body.append("},");
+    }
+    worker.body.append("\"total\":");
+    worker.body.append(to_string(total));
+    worker.body.push_back('}');
+    return 200;
+}
+
+/**
+ * GET /stats/resolve?days=<n>: resolutions in the last n days (all time if 0 or missing) and their mean time to resolve
+ */
+static int handleTimeToResolve(Worker& worker, string_view query) {
+    long long days = 0;
+    if (!queryParameter(query, "days", days) || days > 100000) {
+        return error(worker.body, 400, "days must be a number of days, 0 for all time");
+    }
+    long long now = currentTimeMs();
+    ResolveStats stats;
+    if (!worker.repository.timeToResolve(days > 0 ? now - days * 86400000 : 0, now + 1, stats)) {
+        return error(worker.body, 500, "Database error");
+    }
+    worker.body.assign("{\"resolved\":");
+    worker.body.append(to_string(stats.resolved));
+    worker.body.append(",\"meanMs\":");
+    worker.body.append(stats.resolved > 0 ? to_string(static_cast<long long>(stats.meanMs)) : "null");
+    worker.body.push_back('}');
+    return 200;
+}
+
+/**
+ * GET /stats/aging: bugs not yet resolved grouped by age
+ */
+static int handleAging(Worker& worker) {
+    BugAging aging;
+    if (!worker.repository.openBugAging(currentTimeMs(), aging)) {
+        return error(worker.body, 500, "Database error");
+    }
+    worker.body.assign("{\"buckets\":[");
+    for (size_t i = 0; i < aging.size(); i++) {
+        if (i) worker.body.push_back(',');
+        worker.body.append("{\"age\":");
+        appendJsonString(worker.body, AGING_BUCKET_NAMES[i]);
+        worker.body.append(",\"bugs\":");
+        worker.body.append(to_string(aging[i].bugs));
+        worker.body.append(",\"meanAgeMs\":");
+        worker.body.append(to_string(static_cast<long long>(aging[i].meanAgeMs)));
+        worker.body.append(",\"maxAgeMs\":");
+        worker.body.append(to_string(aging[i].maxAgeMs));
+        worker.body.push_back('}');
+    }
+    worker.body.append("]}");
+    return 200;
+}
+
+/**
+ * GET /cache: the bug cache counters
+ */
+static int handleCacheStats(Worker& worker) {
+    if (!worker.cache) {
+        return error(worker.body, 404, "The bug cache is disabled");
+    }
+    BugCacheStats stats = worker.cache->stats();
+    worker.body.assign("{\"hits\":");
+    worker.body.append(to_string(stats.hits));
+    worker.body.append(",\"misses\":");
+    worker.body.append(to_string(stats.misses));
+    worker.body.append(",\"hitRate\":");
+    worker.body.append(to_string(stats.hitRate()));
+    worker.body.append(",\"evictions\":");
+    worker.body.append(to_string(stats.evictions));
+    worker.body.append(",\"entries\":");
+    worker.body.append(to_string(stats.entries));
+    worker.body.append(",\"bytes\":");
+    worker.body.append(to_string(stats.bytes));
+    worker.body.append(",\"capacityBytes\":");
+    worker.body.append(to_string(stats.capacityBytes));
+    worker.body.push_back('}');
+    return 200;
+}
+
+/**
+ * Routes a request to its handler
+ *   GET    /bugs?after=&limit=   list a page
+ *   POST   /bugs                 add
+ *   GET    /bugs/<id>            get one bug
+ *   PATCH  /bugs/<id>            update status (PUT is accepted as well)
+ *   DELETE /bugs/<id>            delete
+ *   GET    /stats                bug counts per status and priority
+ *   GET    /stats/resolve?days=  resolutions and mean time to resolve
+ *   GET    /stats/aging          bugs not yet resolved grouped by age
+ *   GET    /cache                bug cache counters
+ * @param worker The worker serving the request; the JSON body is left in worker.body
+ * @param request The parsed request
+ * @return HTTP status code
+ */
+static int handleRequest(Worker& worker, const HttpRequest& request) {
+    worker.body.clear();
+    string_view target = request.target;
+    size_t question = target.find('?');
+    string_view path = target.substr(0, question);
+    string_view query = question == string_view::npos ? string_view() : target.substr(question + 1);
+    const string& method = request.method;
+
+    if (path == "/bugs" || path == "/bugs/") {
+        if (method == "GET") return handleList(worker, query);
+        if (method == "POST") return handleAdd(worker, request.body);
+        return error(worker.body, 405, "Use GET or POST on /bugs");
+    }
+
+    if (path == "/stats" || path == "/stats/resolve" || path == "/stats/aging") {
+        if (method != "GET") return error(worker.body, 405, "Use GET on /stats");
+        if (path == "/stats/resolve") return handleTimeToResolve(worker, query);
+        if (path == "/stats/aging") return handleAging(worker);
+        return handleStats(worker);
+    }
+    if (path == "/cache") {
+        if (method == "GET") return handleCacheStats(worker);
+        return error(worker.body, 405, "Use GET on /cache");
+    }
+
+    const string_view prefix = "/bugs/";
+    if (path.substr(0, prefix.size()) != prefix) {
+        return error(worker.body, 404, "Unknown path");
+    }
+    BugId id;
+    if (!parseBugId(path.substr(prefix.size()), id)) {
+        return error(worker.body, 404, "Bug IDs are positive numbers");
+    }
+
+    if (method == "GET") {
+        optional<Bug> bug = worker.repository.get(id);
+        if (!bug) {
+            return error(worker.body, 404, "No bug has this ID");
+        }
+        appendBugJson(worker.body, viewOf(*bug));
+        return 200;
+    }
+    if (method == "PATCH" || method == "PUT") {
+        return handleUpdate(worker, id, request.body);
+    }
+    if (method == "DELETE") {
+        MutationResult result = worker.writes ? worker.writes->submitRemove(id).get() : worker.repository.remove(id);
+        switch (result) {
+        case MutationResult::Done: return 204;
+        case MutationResult::NotFound: return error(worker.body, 404, "No bug has this ID");
+        default: return error(worker.body, 500, "Database error");
+        }
+    }
+    return error(worker.body, 405, "Use GET, PATCH, PUT or DELETE on /bugs/<id>");
+}
+
+/**
+ * Sends a whole buffer on a non-blocking socket, waiting for the socket to drain when needed
+ * @return true if every byte was sent, false if the peer went away or stalled
+ */
+static bool sendAll(socket_t socket, const string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        long long n = send(socket, data.data() + sent, static_cast<int>(data.size() - sent), SEND_FLAGS);
+        if (n > 0) {
+            sent += static_cast<size_t>(n);
+            continue;
+        }
+        if (n < 0 && lastErrorInterrupted()) {
+            continue;
+        }
+        if (n < 0 && lastErrorWouldBlock()) {
+            pollfd writable = { socket, POLLOUT, 0 };
+            if (pollSockets(&writable, 1, static_cast<int>(chrono::milliseconds(KEEP_ALIVE_TIMEOUT).count())) > 0) {
+                continue;
+            }
+        }
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Answers a request that could not be parsed and leaves the connection to be closed
+ */
+static void rejectRequest(socket_t socket, ParseResult result) {
+    string body;
+    string response;
+    int status = result == ParseResult::TooLarge
+        ? error(body, 413, "Request head or body too large")
+        : error(body, 400, "Malformed HTTP request");
+    formatResponse(response, status, body, false);
+    sendAll(socket, response);
+}
+
+/**
+ * Event-driven HTTP server: one acceptor thread polls the listening socket and every idle
+ * keep-alive connection, and hands each fully received request to a pool of worker threads.
+ * Every worker owns a BugRepository in WAL mode, so reads run in parallel and never wait
+ * for the single writer; writers queue on the database lock for up to BUSY_TIMEOUT_MS.
+ * With --group-commit every change goes through a shared WriteQueue, which commits concurrent changes together.
+ * All repositories share one BugCache, so a bug read by one worker is a hit for every other.
+ */
+class HttpServer {
+public:
+    explicit HttpServer(const ServerOptions& options) : options(options), cache(options.bugCacheBytes) {}
+    ~HttpServer();
+    HttpServer(const HttpServer&) = delete;
+    HttpServer& operator=(const HttpServer&) = delete;
+
+    bool start();
+    void run();
+    const BugCache& bugCache() const { return cache; }
+
+private:
+    void workerLoop(Worker& worker);
+    void dispatch(unique_ptr<Connection> connection);
+    void giveBack(unique_ptr<Connection> connection);
+    bool receive(Connection& connection);
+
+    ServerOptions options;
+    BugCache cache;
+    socket_t listener = INVALID_SOCKET_HANDLE;
+    socket_t wake[2] = { INVALID_SOCKET_HANDLE, INVALID_SOCKET_HANDLE };
+    WriteQueue writes;
+    vector<unique_ptr<Worker>> workers;
+    vector<thread> threads;
+
+    // Connections with a complete request, waiting for a worker
+    mutex pendingMutex;
+    condition_variable pendingReady;
+    deque<unique_ptr<Connection>> pending;
+    bool stopping = false;
+
+    // Keep-alive connections handed back by workers, picked up by the acceptor
+    mutex returnedMutex;
+    vector<unique_ptr<Connection>> returned;
+};
+
+/**
+ * Stops the workers and closes every socket and database connection
+ */
+HttpServer::~HttpServer() {
+    {
+        lock_guard<mutex> lock(pendingMutex);
+        stopping = true;
+    }
+    pendingReady.notify_all();
+    for (thread& t : threads) {
+        t.join();
+    }
+    for (socket_t socket : { listener, wake[0], wake[1] }) {
+        if (socket != INVALID_SOCKET_HANDLE) {
+            closeSocket(socket);
+        }
+    }
+}
+
+/**
+ * Opens the worker connections, binds the listening socket and starts the worker threads
+ * @return true if the server is ready to run, false otherwise
+ */
+bool HttpServer::start() {
+    if (!initSockets()) {
+        cerr << "Can't initialize sockets." << endl;
+        return false;
+    }
+    if (sqlite3_threadsafe() == 0) {
+        cerr << "SQLite was built with SQLITE_THREADSAFE=0 and can't serve from several threads." << endl;
+        return false;
+    }
+
+    // WAL lets every worker read while another one writes
+    PragmaProfile profile = options.profile;
+    profile.journalMode = "WAL";
+    int count = options.workers > 0 ? options.workers : static_cast<int>(max(1u, thread::hardware_concurrency()));
+    for (int i = 0; i < count; i++) {
+        // Opened one after another so only the first connection runs migrations
+        auto worker = make_unique<Worker>();
+        if (!worker->repository.open(options.databasePath, profile) ||
+            !worker->repository.execute("PRAGMA busy_timeout = " + to_string(BUSY_TIMEOUT_MS) + ";")) {
+            return false;
+        }
+        if (options.groupCommit) {
+            worker->writes = &writes;
+        }
+        if (options.bugCacheBytes > 0) {
+            worker->repository.setCache(&cache);
+            worker->cache = &cache;
+        }
+        workers.push_back(move(worker));
+    }
+    if (options.bugCacheBytes > 0) {
+        writes.setCache(&cache);
+    }
+    // Requests block until their change commits, so a batch can only grow while the previous one
+    // commits; waiting for more changes would add latency without making batches larger
+    if (options.groupCommit &&
+        !writes.open(options.databasePath, profile, DEFAULT_MAX_BATCH_ROWS, chrono::microseconds(0))) {
+        return false;
+    }
+
+    if (!makeSocketPair(wake) || !setNonBlocking(wake[0]) || !setNonBlocking(wake[1])) {
+        cerr << "Can't create the wakeup socket pair." << endl;
+        return false;
+    }
+
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<unsigned short>(options.port));
+    if (inet_pton(AF_INET, options.bindAddress.c_str(), &address.sin_addr) != 1) {
+        cerr << "Invalid bind address: " << options.bindAddress << endl;
+        return false;
+    }
+    listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    int reuse = 1;
+    if (listener == INVALID_SOCKET_HANDLE ||
+        setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse)) != 0 ||
+        ::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(listener, SOMAXCONN) != 0 ||
+        !setNonBlocking(listener)) {
+        cerr << "Can't listen on " << options.bindAddress << ":" << options.port << endl;
+        return false;
+    }
+
+    for (auto& worker : workers) {
+        threads.emplace_back(&HttpServer::workerLoop, this, ref(*worker));
+    }
+    cout << "Serving http://" << options.bindAddress << ":" << options.port << "/bugs with "
+        << count << " workers. Press Ctrl+C to stop." << endl;
+    return true;
+}
+
+/**
+ * Queues a connection with a complete request for the next free worker
+ */
+void HttpServer::dispatch(unique_ptr<Connection> connection) {
+    {
+        lock_guard<mutex> lock(pendingMutex);
+        pending.push_back(move(connection));
+    }
+    pendingReady.notify_one();
+}
+
+/**
+ * Returns a kept-alive connection to the acceptor and wakes it up
+ */
+void HttpServer::giveBack(unique_ptr<Connection> connection) {
+    {
+        lock_guard<mutex> lock(returnedMutex);
+        returned.push_back(move(connection));
+    }
+    // A full socket buffer already holds a pending wakeup, so a failed send is harmless
+    char wakeup = 1;
+    send(wake[1], &wakeup, 1, SEND_FLAGS);
+}
+
+/**
+ * Serves requests until the server stops
+ * Pipelined requests already received are answered before the connection goes back to the acceptor.
+ */
+void HttpServer::workerLoop(Worker& worker) {
+    while (true) {
+        unique_ptr<Connection> connection;
+        {
+            unique_lock<mutex> lock(pendingMutex);
+            pendingReady.wait(lock, [this] { return stopping || !pending.empty(); });
+            if (stopping) {
+                return;
+            }
+            connection = move(pending.front());
+            pending.pop_front();
+        }
+
+        ParseResult next;
+        bool keepAlive;
+        do {
+            int status = handleRequest(worker, connection->request);
+            keepAlive = connection->request.keepAlive;
+            formatResponse(worker.response, status, worker.body, keepAlive);
+            if (!sendAll(connection->socket, worker.response)) {
+                keepAlive = false;
+                break;
+            }
+            next = keepAlive ? parseRequest(*connection) : ParseResult::Incomplete;
+        } while (keepAlive && next == ParseResult::Complete);
+
+        if (keepAlive && next != ParseResult::Incomplete) {
+            rejectRequest(connection->socket, next);
+            keepAlive = false;
+        }
+        if (keepAlive) {
+            connection->lastActive = chrono::steady_clock::now();
+            giveBack(move(connection));
+        }
+    }
+}
+
+/**
+ * Reads everything currently available on a non-blocking connection
+ * @return false if the peer closed the connection or it failed, true otherwise
+ */
+bool HttpServer::receive(Connection& connection) {
+    char buffer[16384];
+    while (true) {
+        long long n = recv(connection.socket, buffer, static_cast<int>(sizeof(buffer)), 0);
+        if (n > 0) {
+            connection.input.append(buffer, static_cast<size_t>(n));
+            if (connection.input.size() > MAX_REQUEST_HEAD + MAX_REQUEST_BODY) {
+                return true;
+            }
+            continue;
+        }
+        if (n < 0 && lastErrorInterrupted()) {
+            continue;
+        }
+        return n < 0 && lastErrorWouldBlock();
+    }
+}
+
+/**
+ * Runs the acceptor loop until SIGINT or SIGTERM
+ */
+void HttpServer::run() {
+    unordered_map<socket_t, unique_ptr<Connection>> idle;
+    vector<pollfd> fds;
+    vector<socket_t> closed;
+
+    while (!stopRequested) {
+        fds.clear();
+        fds.push_back({ wake[0], POLLIN, 0 });
+        fds.push_back({ listener, POLLIN, 0 });
+        for (const auto& entry : idle) {
+            fds.push_back({ entry.first, POLLIN, 0 });
+        }
+
+        int ready = pollSockets(fds.data(), fds.size(), POLL_INTERVAL_MS);
+        if (ready < 0) {
+            if (lastErrorInterrupted()) {
+                continue;
+            }
+            cerr << "poll failed, stopping the server." << endl;
+            break;
+        }
+        auto now = chrono::steady_clock::now();
+
+        // Connections handed back by workers
+        if (fds[0].revents & POLLIN) {
+            char drain[256];
+            while (recv(wake[0], drain, static_cast<int>(sizeof(drain)), 0) > 0) {
+            }
+            lock_guard<mutex> lock(returnedMutex);
+            for (auto& connection : returned) {
+                socket_t socket = connection->socket;
+                idle.emplace(socket, move(connection));
+            }
+            returned.clear();
+        }
+
+        // New clients
+        if (fds[1].revents & POLLIN) {
+            socket_t client;
+            while ((client = accept(listener, nullptr, nullptr)) != INVALID_SOCKET_HANDLE) {
+                if (!setNonBlocking(client)) {
+                    closeSocket(client);
+                    continue;
+                }
+                setNoDelay(client);
+                idle.emplace(client, make_unique<Connection>(client));
+            }
+        }
+
+        // Requests arriving on idle connections
+        for (size_t i = 2; i < fds.size(); i++) {
+            if (!fds[i].revents) {
+                continue;
+            }
+            auto it = idle.find(fds[i].fd);
+            if (it == idle.end()) {
+                continue;
+            }
+            Connection& connection = *it->second;
+            connection.lastActive = now;
+            bool open = receive(connection);
+
+            ParseResult result = parseRequest(connection);
+            if (result == ParseResult::Complete) {
+                unique_ptr<Connection> owned = move(it->second);
+                idle.erase(it);
+                dispatch(move(owned));
+            } else if (result != ParseResult::Incomplete) {
+                rejectRequest(connection.socket, result);
+                idle.erase(it);
+            } else if (!open) {
+                idle.erase(it);
+            }
+        }
+
+        // Drop keep-alive connections that went quiet
+        closed.clear();
+        for (const auto& entry : idle) {
+            if (now - entry.second->lastActive > KEEP_ALIVE_TIMEOUT) {
+                closed.push_back(entry.first);
+            }
+        }
+        for (socket_t socket : closed) {
+            idle.erase(socket);
+        }
+    }
+}
+
+/**
+ * Serves the bug API over HTTP until the process receives SIGINT or SIGTERM
+ * @param options Address, port, worker count and database settings
+ * @return true after a clean shutdown, false if the server could not start
+ */
+bool runServer(const ServerOptions& options) {
+    stopRequested = 0;
+    signal(SIGINT, requestStop);
+    signal(SIGTERM, requestStop);
+#ifdef SIGPIPE
+    signal(SIGPIPE, SIG_IGN);
+#endif
+
+    HttpServer server(options);
+    if (!server.start()) {
+        return false;
+    }
+    server.run();
+    cout << "Server stopped." << endl;
+    if (options.printCacheStats) {
+        server.bugCache().printStats();
+    }
+    return true;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "BugRepository.h"
+#include <string>
+
+// Port used by --serve when --port is not given
+inline constexpr int DEFAULT_SERVER_PORT = 8080;
+
+// Most worker threads, and so connections, --workers may ask for
+inline constexpr int MAX_SERVER_WORKERS = 256;
+
+/**
+ * Settings for the HTTP/JSON server started with --serve
+ */
+struct ServerOptions {
+    std::string databasePath = "bugs.db";
+    std::string bindAddress = "127.0.0.1";  // IPv4 address to listen on; loopback keeps the API local
+    int port = DEFAULT_SERVER_PORT;
+    int workers = 0;                        // Worker threads, each with its own connection; 0 uses one per CPU
+    bool groupCommit = false;               // Send every change through one WriteQueue instead of each worker's connection
+    size_t bugCacheBytes = DEFAULT_BUG_CACHE_BYTES; // Memory cap of the bug cache shared by all workers; 0 disables it
+    bool printCacheStats = false;           // Print the bug cache counters on shutdown
+    PragmaProfile profile;                  // Applied to every worker connection, always in WAL mode
+};
+
+bool runServer(const ServerOptions& options);
@@ -0,0 +1,215 @@
+#include "Json.h"
+#include <string>
+#include <string_view>
+#include <charconv>
+#include <system_error>
+
+using namespace std;
+
+// Whitespace allowed between JSON tokens
+static const char* const JSON_WHITESPACE = " \t\r\n";
+
+/**
+ * Appends a code point to a string as UTF-8
+ * @param out The string to append to
+ * @param cp The Unicode code point
+ */
+void appendUtf8(string& out, unsigned long cp) {
+    if (cp < 0x80) {
+        out.push_back(static_cast<char>(cp));
+    } else if (cp < 0x800) {
+        out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else if (cp < 0x10000) {
+        out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else {
+        out.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    }
+}
+
+/**
+ * Reads the four hex digits of a \u escape
+ * Anything but exactly four hex digits (a sign, whitespace, a shorter number) is rejected.
+ * @param text The JSON text
+ * @param pos Position of the first digit
+ * @param value Receives the UTF-16 code unit
+ * @return true if the four characters are hex digits, false otherwise
+ */
+static bool parseHex4(const string& text, size_t pos, unsigned long& value) {
+    if (pos + 4 > text.size()) {
+        return false;
+    }
+    const char* first = text.data() + pos;
+    auto result = from_chars(first, first + 4, value, 16);
+    return result.ec == errc() && result.ptr == first + 4;
+}
+
+/**
+ * Parses a JSON string literal starting at the opening quote
+ * @param text The JSON text
+ * @param pos Position of the opening quote; moved past the closing quote
+ * @param out Receives the unescaped string
+ * @return true if a complete string literal was parsed, false otherwise
+ */
+bool parseJsonString(const string& text, size_t& pos, string& out) {
+    out.clear();
+    if (pos >= text.size() || text[pos] != '"') {
+        return false;
+    }
+    pos++;
+    while (pos < text.size()) {
+        char c = text[pos++];
+        if (c == '"') {
+            return true;
+        }
+        if (c != '\\') {
+            out.push_back(c);
+            continue;
+        }
+        if (pos >= text.size()) {
+            return false;
+        }
+        char e = text[pos++];
+        switch (e) {
+        case '"': out.push_back('"'); break;
+        case '\\': out.push_back('\\'); break;
+        case '/': out.push_back('/'); break;
+        case 'b': out.push_back('\b'); break;
+        case 'f': out.push_back('\f'); break;
+        case 'n': out.push_back('\n'); break;
+        case 'r': out.push_back('\r'); break;
+        case 't': out.push_back('\t'); break;
+        case 'u': {
+            unsigned long cp;
+            if (!parseHex4(text, pos, cp)) {
+                return false;
+            }
+            pos += 4;
+            // Combine a UTF-16 surrogate pair into a single code point
+            if (cp >= 0xD800 && cp <= 0xDBFF && pos + 2 <= text.size() &&
+                text[pos] == '\\' && text[pos + 1] == 'u') {
+                unsigned long low;
+                if (!parseHex4(text, pos + 2, low)) {
+                    return false;
+                }
+                if (low >= 0xDC00 && low <= 0xDFFF) {
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                    pos += 6;
+                }
+            }
+            appendUtf8(out, cp);
+            break;
+        }
+        default:
+            return false;
+        }
+    }
+    return false;
+}
+
+/**
+ * Appends a string to a buffer as a quoted, escaped JSON string literal
+ * @param out The buffer to append to
+ * @param value The raw string
+ */
+void appendJsonString(string& out, string_view value) {
+    static const char hex[] = "0123456789abcdef";
+    out.push_back('"');
+    size_t runStart = 0;
+    for (size_t i = 0; i < value.size(); i++) {
+        unsigned char c = static_cast<unsigned char>(value[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        // Copy the run of characters that need no escaping in one append
+        out.append(value.data() + runStart, i - runStart);
+        runStart = i + 1;
+        switch (c) {
+        case '"': out.append("\\\""); break;
+        case '\\': out.append("\\\\"); break;
+        case '\n': out.append("\\n"); break;
+        case '\r': out.append("\\r"); break;
+        case '\t': out.append("\\t"); break;
+        default:
+            out.append("\\u00");
+            out.push_back(hex[c >> 4]);
+            out.push_back(hex[c & 0xF]);
+        }
+    }
+    out.append(value.data() + runStart, value.size() - runStart);
+    out.push_back('"');
+}
+
+/**
+ * Parses a flat JSON object whose values are strings, numbers, booleans or null
+ * String values are unescaped; other values are kept as their literal text. Nested objects and arrays are rejected.
+ * @param text A single JSON object, optionally surrounded by whitespace
+ * @param fields Receives the keys and values in document order
+ * @return true if the text is a well-formed flat JSON object, false otherwise
+ */
+bool parseJsonObject(const string& text, JsonFields& fields) {
+    fields.clear();
+    size_t pos = text.find_first_not_of(JSON_WHITESPACE);
+    if (pos == string::npos || text[pos] != '{') {
+        return false;
+    }
+    pos++;
+
+    string key;
+    string value;
+    while (true) {
+        pos = text.find_first_not_of(JSON_WHITESPACE, pos);
+        if (pos == string::npos) {
+            return false;
+        }
+        if (text[pos] == '}' && fields.empty()) {
+            return text.find_first_not_of(JSON_WHITESPACE, pos + 1) == string::npos;
+        }
+        // After a comma another key must follow
+        if (!parseJsonString(text, pos, key)) {
+            return false;
+        }
+        pos = text.find_first_not_of(JSON_WHITESPACE, pos);
+        if (pos == string::npos || text[pos] != ':') {
+            return false;
+        }
+        pos = text.find_first_not_of(JSON_WHITESPACE, pos + 1);
+        if (pos == string::npos) {
+            return false;
+        }
+
+        if (text[pos] == '"') {
+            if (!parseJsonString(text, pos, value)) {
+                return false;
+            }
+        } else {
+            // Numbers, booleans and null are kept as their literal text
+            size_t end = text.find_first_of(",} \t\r\n", pos);
+            if (end == string::npos || text[pos] == '{' || text[pos] == '[') {
+                return false;
+            }
+            value = text.substr(pos, end - pos);
+            pos = end;
+        }
+
+        fields.emplace_back(key, value);
+
+        pos = text.find_first_not_of(JSON_WHITESPACE, pos);
+        if (pos == string::npos) {
+            return false;
+        }
+        if (text[pos] == '}') {
+            // Nothing but whitespace may follow the object
+            return text.find_first_not_of(JSON_WHITESPACE, pos + 1) == string::npos;
+        }
+        if (text[pos] != ',') {
+            return false;
+        }
+        pos++;
+    }
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Key/value pairs of a flat JSON object, in document order
+typedef std::vector<std::pair<std::string, std::string>> JsonFields;
+
+void appendUtf8(std::string& out, unsigned long cp);
+void appendJsonString(std::string& out, std::string_view value);
+bool parseJsonString(const std::string& text, size_t& pos, std::string& out);
+bool parseJsonObject(const std::string& text, JsonFields& fields);
@@ -0,0 +1,234 @@
+#include "OutputWriter.h"
+#include "Json.h"
+#include <charconv>
+#include <cstring>
+#include <iterator>
+
+using namespace std;
+
+/**
+ * Parses an output format name
+ * @param name One of "table", "csv" or "ndjson"
+ * @param format Receives the parsed format
+ * @return true if the name is a known format, false otherwise
+ */
+bool parseOutputFormat(const string& name, OutputFormat& format) {
+    if (name == "table") format = OutputFormat::Table;
+    else if (name == "csv") format = OutputFormat::Csv;
+    else if (name == "ndjson") format = OutputFormat::Ndjson;
+    else return false;
+    return true;
+}
+
+/**
+ * Creates a writer with an empty buffer
+ * @param out Stream the buffer is written to
+ * @param flushThreshold Buffer size in bytes at which a row triggers a flush
+ */
+OutputWriter::OutputWriter(ostream& out, size_t flushThreshold)
+    : out(out), flushThreshold(flushThreshold) {
+    buffer.reserve(flushThreshold + 4096);
+}
+
+/**
+ * Starts a new result set; the CSV header is written again before its first row
+ */
+void OutputWriter::beginResult() {
+    headerWritten = false;
+    columnNames.clear();
+}
+
+/**
+ * Formats the current row of a statement into the buffer
+ * @param stmt A statement positioned on a row
+ */
+void OutputWriter::writeRow(sqlite3_stmt* stmt) {
+    int columns = sqlite3_column_count(stmt);
+    if (static_cast<int>(columnNames.size()) != columns) {
+        resolveColumns(stmt);
+    }
+    writeFields(columns, [stmt](int i) { return sqlite3_column_name(stmt, i); },
+        [this, stmt](int i, const char*& value, int& length) { return fetchColumn(stmt, i, value, length); });
+}
+
+/**
+ * Formats a record of ready-made values into the buffer, for results that do not come from a statement
+ * @param names Column names
+ * @param values Column values as text; the value of a NULL column is ignored
+ * @param types SQLite type of each value (SQLITE_INTEGER, SQLITE_TEXT or SQLITE_NULL)
+ * @param columns Number of columns
+ */
+void OutputWriter::writeValues(const char* const* names, const string* values, const int* types, int columns) {
+    writeFields(columns, [names](int i) { return names[i]; },
+        [values, types](int i, const char*& value, int& length) {
+            value = values[i].data();
+            length = static_cast<int>(values[i].size());
+            return types[i];
+        });
+}
+
+/**
+ * Formats a bug with the same columns and display rules as a row of a bug query
+ * @param bug The bug
+ */
+void OutputWriter::writeBug(const Bug& bug) {
+    static const char* const names[] = { "ID", "Title", "Description", "Status", "Priority", "Created", "Updated" };
+    int timeType = format == OutputFormat::Table ? SQLITE_TEXT : SQLITE_INTEGER;
+    const int types[] = { SQLITE_INTEGER, SQLITE_TEXT, SQLITE_TEXT, SQLITE_TEXT, SQLITE_TEXT, timeType, timeType };
+    auto time = [this](sqlite3_int64 ms) { return format == OutputFormat::Table ? formatTimestamp(ms) : to_string(ms); };
+    const string values[] = {
+        to_string(bug.id.value), bug.title, bug.description,
+        STATUS_NAMES[static_cast<int>(bug.status)], PRIORITY_NAMES[static_cast<int>(bug.priority)],
+        time(bug.created), time(bug.updated)
+    };
+    writeValues(names, values, types, static_cast<int>(size(names)));
+}
+
+/**
+ * Writes the buffered output to the stream
+ */
+void OutputWriter::flush() {
+    if (!buffer.empty()) {
+        out.write(buffer.data(), static_cast<streamsize>(buffer.size()));
+        buffer.clear();
+    }
+    out.flush();
+}
+
+/**
+ * Formats one record into the buffer in the current format
+ * @param columns Number of columns
+ * @param name Returns the name of column i
+ * @param fetch Sets value and length of column i and returns its SQLite type as it should be written
+ */
+template <typename Name, typename Fetch>
+void OutputWriter::writeFields(int columns, Name name, Fetch fetch) {
+    const char* value;
+    int length;
+    switch (format) {
+    case OutputFormat::Table:
+        for (int i = 0; i < columns; i++) {
+            buffer.append(name(i));
+            buffer.append(": ");
+            if (fetch(i, value, length) != SQLITE_NULL) buffer.append(value, length);
+            else buffer.append("NULL");
+            buffer.push_back('\n');
+        }
+        buffer.append("------------------------\n");
+        break;
+
+    case OutputFormat::Csv:
+        if (!headerWritten) {
+            for (int i = 0; i < columns; i++) {
+                if (i) buffer.push_back(',');
+                buffer.append(name(i));
+            }
+            buffer.push_back('\n');
+            headerWritten = true;
+        }
+        for (int i = 0; i < columns; i++) {
+            if (i) buffer.push_back(',');
+            if (fetch(i, value, length) != SQLITE_NULL) appendCsvField(value, length);
+        }
+        buffer.push_back('\n');
+        break;
+
+    case OutputFormat::Ndjson:
+        buffer.push_back('{');
+        for (int i = 0; i < columns; i++) {
+            if (i) buffer.push_back(',');
+            appendJsonString(buffer, name(i));
+            buffer.push_back(':');
+            int type = fetch(i, value, length);
+            if (type == SQLITE_NULL) buffer.append("null");
+            else if (type == SQLITE_INTEGER || type == SQLITE_FLOAT) buffer.append(value, length);
+            else appendJsonString(buffer, string_view(value, length));
+        }
+        buffer.append("}\n");
+        break;
+    }
+
+    if (buffer.size() >= flushThreshold) {
+        flush();
+    }
+}
+
+/**
+ * Records which columns hold Status or Priority codes that are shown by name,
+ * and which hold Created or Updated times that tables show as dates
+ */
+void OutputWriter::resolveColumns(sqlite3_stmt* stmt) {
+    int columns = sqlite3_column_count(stmt);
+    columnNames.assign(columns, nullptr);
+    timestampColumns.assign(columns, false);
+    for (int i = 0; i < columns; i++) {
+        const char* name = sqlite3_column_name(stmt, i);
+        if (strcmp(name, "Status") == 0) columnNames[i] = STATUS_NAMES;
+        else if (strcmp(name, "Priority") == 0) columnNames[i] = PRIORITY_NAMES;
+        else if (strcmp(name, "Created") == 0 || strcmp(name, "Updated") == 0) timestampColumns[i] = true;
+    }
+}
+
+/**
+ * Fetches a column value as text, mapping Status and Priority codes to their display names
+ * Tables show times as UTC dates; CSV and NDJSON keep the epoch milliseconds.
+ * @return The SQLite type of the value as it should be written
+ */
+int OutputWriter::fetchColumn(sqlite3_stmt* stmt, int i, const char*& value, int& length) {
+    int type = sqlite3_column_type(stmt, i);
+    if (type == SQLITE_INTEGER && columnNames[i]) {
+        int code = sqlite3_column_int(stmt, i);
+        if (code >= 0 && code <= 2) {
+            value = columnNames[i][code];
+            length = static_cast<int>(strlen(value));
+            return SQLITE_TEXT;
+        }
+    }
+    if (type == SQLITE_INTEGER && timestampColumns[i] && format == OutputFormat::Table) {
+        string_view text = formatTimestamp(sqlite3_column_int64(stmt, i), fieldText);
+        value = text.data();
+        length = static_cast<int>(text.size());
+        return SQLITE_TEXT;
+    }
+    if (type == SQLITE_INTEGER) {
+        // Formatted here rather than by sqlite3_column_text(), which converts the value in the row buffer
+        auto result = to_chars(fieldText, fieldText + sizeof(fieldText), sqlite3_column_int64(stmt, i));
+        value = fieldText;
+        length = static_cast<int>(result.ptr - fieldText);
+        return SQLITE_INTEGER;
+    }
+    value = reinterpret_cast<const char*>(sqlite3_column_text(stmt, i));
+    length = sqlite3_column_bytes(stmt, i);
+    return type;
+}
+
+/**
+ * Appends a CSV field, quoted when it holds a comma, quote or line break
+ */
+void OutputWriter::appendCsvField(const char* value, int length) {
+    bool needsQuotes = false;
+    for (int i = 0; i < length; i++) {
+        char c = value[i];
+        if (c == ',' || c == '"' || c == '\n' || c == '\r') {
+            needsQuotes = true;
+            break;
+        }
+    }
+    if (!needsQuotes) {
+        buffer.append(value, length);
+        return;
+    }
+    buffer.push_back('"');
+    for (int i = 0; i < length; i++) {
+        if (value[i] == '"') buffer.push_back('"');
+        buffer.push_back(value[i]);
+    }
+    buffer.push_back('"');
+}
+
+/**
+ * Writes one row to the output writer passed as context
+ */
+void writeRowVisitor(sqlite3_stmt* stmt, void* context) {
+    static_cast<OutputWriter*>(context)->writeRow(stmt);
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Bug.h"
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * Output formats supported by OutputWriter
+ */
+enum class OutputFormat {
+    Table,
+    Csv,
+    Ndjson
+};
+
+bool parseOutputFormat(const std::string& name, OutputFormat& format);
+
+/**
+ * Formats result rows into a reusable buffer and writes it to a stream in large chunks
+ * The buffer is written when flush() is called or when it grows past the flush threshold,
+ * so a listing costs a handful of writes instead of one flush per column.
+ */
+class OutputWriter {
+public:
+    explicit OutputWriter(std::ostream& out, size_t flushThreshold = 1 << 20);
+
+    void setFormat(OutputFormat newFormat) { format = newFormat; }
+    OutputFormat getFormat() const { return format; }
+
+    void beginResult();
+    void writeRow(sqlite3_stmt* stmt);
+    void writeValues(const char* const* names, const std::string* values, const int* types, int columns);
+    void writeBug(const Bug& bug);
+    void flush();
+
+private:
+    template <typename Name, typename Fetch>
+    void writeFields(int columns, Name name, Fetch fetch);
+    void resolveColumns(sqlite3_stmt* stmt);
+    int fetchColumn(sqlite3_stmt* stmt, int i, const char*& value, int& length);
+    void appendCsvField(const char* value, int length);
+
+    std::ostream& out;
+    std::string buffer;
+    size_t flushThreshold;
+    OutputFormat format = OutputFormat::Table;
+    bool headerWritten = false;
+    std::vector<const char* const*> columnNames;
+    std::vector<bool> timestampColumns;
+    char fieldText[TIMESTAMP_TEXT_SIZE];    // Text of the integer or time last fetched by fetchColumn()
+};
+
+// Row visitor that writes each row to the OutputWriter passed as context
+void writeRowVisitor(sqlite3_stmt* stmt, void* context);
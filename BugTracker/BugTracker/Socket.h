@@ -0,0 +1,138 @@
+#pragma once
+
+// Thin portability layer over Winsock and BSD sockets, shared by the HTTP server and its load test
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+
+typedef SOCKET socket_t;
+const socket_t INVALID_SOCKET_HANDLE = INVALID_SOCKET;
+
+// Winsock never raises SIGPIPE
+const int SEND_FLAGS = 0;
+
+inline bool initSockets() {
+    WSADATA data;
+    return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+}
+
+inline void closeSocket(socket_t socket) {
+    closesocket(socket);
+}
+
+inline int pollSockets(pollfd* fds, size_t count, int timeoutMs) {
+    return WSAPoll(fds, static_cast<ULONG>(count), timeoutMs);
+}
+
+inline bool setNonBlocking(socket_t socket) {
+    u_long mode = 1;
+    return ioctlsocket(socket, FIONBIO, &mode) == 0;
+}
+
+inline bool lastErrorWouldBlock() {
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+}
+
+inline bool lastErrorInterrupted() {
+    return WSAGetLastError() == WSAEINTR;
+}
+
+/**
+ * Creates a connected pair of loopback TCP sockets, standing in for socketpair()
+ * @param pair Receives the two ends
+ * @return true on success, false otherwise
+ */
+inline bool makeSocketPair(socket_t pair[2]) {
+    socket_t listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (listener == INVALID_SOCKET) {
+        return false;
+    }
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    int length = sizeof(address);
+    bool ok = bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0 &&
+        getsockname(listener, reinterpret_cast<sockaddr*>(&address), &length) == 0 &&
+        listen(listener, 1) == 0;
+    pair[0] = pair[1] = INVALID_SOCKET;
+    if (ok) {
+        pair[0] = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        ok = pair[0] != INVALID_SOCKET &&
+            connect(pair[0], reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+    }
+    if (ok) {
+        pair[1] = accept(listener, nullptr, nullptr);
+        ok = pair[1] != INVALID_SOCKET;
+    }
+    closesocket(listener);
+    if (!ok && pair[0] != INVALID_SOCKET) {
+        closesocket(pair[0]);
+    }
+    return ok;
+}
+#else
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+
+typedef int socket_t;
+const socket_t INVALID_SOCKET_HANDLE = -1;
+
+// Report a closed peer as EPIPE instead of killing the process with SIGPIPE
+#ifdef MSG_NOSIGNAL
+const int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+const int SEND_FLAGS = 0;
+#endif
+
+inline bool initSockets() {
+    return true;
+}
+
+inline void closeSocket(socket_t socket) {
+    close(socket);
+}
+
+inline int pollSockets(pollfd* fds, size_t count, int timeoutMs) {
+    return poll(fds, static_cast<nfds_t>(count), timeoutMs);
+}
+
+inline bool setNonBlocking(socket_t socket) {
+    int flags = fcntl(socket, F_GETFL, 0);
+    return flags >= 0 && fcntl(socket, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+inline bool lastErrorWouldBlock() {
+    return errno == EAGAIN || errno == EWOULDBLOCK;
+}
+
+inline bool lastErrorInterrupted() {
+    return errno == EINTR;
+}
+
+inline bool makeSocketPair(socket_t pair[2]) {
+    return socketpair(AF_UNIX, SOCK_STREAM, 0, pair) == 0;
+}
+#endif
+
+/**
+ * Disables Nagle's algorithm so small request and response writes are sent immediately
+ */
+inline void setNoDelay(socket_t socket) {
+    int enable = 1;
+    setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&enable), sizeof(enable));
+}
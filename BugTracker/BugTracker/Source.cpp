@@ -1,191 +1,1074 @@
-// Include SQLite3 C API
-extern "C" {
-#include "sqlite3.h"
-}
+#include "BugRepository.h"
+#include "Export.h"
+#include "HttpServer.h"
+#include "Json.h"
 #include <iostream>
+#include <fstream>
+#include <iomanip>
 #include <string>
+#include <vector>
 #include <algorithm>
 #include <regex>
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
+#include <utility>
+#include <thread>
+#include <limits>
+#include <type_traits>
+#include <charconv>
+#include <filesystem>
 
 using namespace std;
 
-// Global database connection pointer
-sqlite3* db;
+/**
+ * Generic input validation function that keeps prompting until valid input is received
+ * @param prompt The prompt to display to the user
+ * @param errorMsg The error message to display for invalid input
+ * @param validator Function pointer to the validation function to use
+ * @return The validated input string
+ */
+string getValidInput(const string& prompt, const string& errorMsg, bool (*validator)(const string&)) {
+    string input;
+    while (true) {
+        cout << prompt;
+        getline(cin, input);
+        if (validator(input)) {
+            return input;
+        }
+        cout << errorMsg << endl;
+    }
+}
 
 /**
- * Executes a SQL query and handles any errors that occur
- * @param sql The SQL query string to execute
+ * Prompts for a bug ID until a valid one is entered
+ * @param prompt The prompt to display to the user
+ * @return The parsed bug ID
  */
-void executeSQL(const string& sql) {
-    char* errMsg = nullptr;
-    int rc = sqlite3_exec(db, sql.c_str(), nullptr, nullptr, &errMsg);
-    if (rc != SQLITE_OK) {
-        cerr << "SQL Error: " << errMsg << endl;
-        sqlite3_free(errMsg);
+BugId getValidBugId(const string& prompt) {
+    string input;
+    BugId id;
+    while (true) {
+        cout << prompt;
+        getline(cin, input);
+        if (parseBugId(input, id)) {
+            return id;
+        }
+        cout << "Invalid ID. Please enter a positive number." << endl;
     }
 }
 
 /**
- * Creates the bugs table if it doesn't exist
- * Defines the schema with columns for ID, Title, Description, Status, Priority, and Date
+ * Adds a new bug to the database
+ * Prompts for and validates title, description, and priority
+ * @param repository The open bug repository
  */
-void createTable() {
-    string sql = R"(CREATE TABLE IF NOT EXISTS bugs (
-        ID INTEGER PRIMARY KEY AUTOINCREMENT,
-        Title TEXT NOT NULL,
-        Description TEXT,
-        Status TEXT DEFAULT 'Open',
-        Priority TEXT,
-        Date TEXT DEFAULT CURRENT_DATE
-    );)";
-    executeSQL(sql);
+void addBug(BugRepository& repository) {
+    string title = getValidInput("Title: ", 
+        "Invalid title. Title must not be empty and must be less than 100 characters.", 
+        isValidTitle);
+    
+    string description = getValidInput("Description: ", 
+        "Invalid description. Description must not be empty and must be less than 1000 characters.", 
+        isValidDescription);
+    
+    string priority = getValidInput("Priority (Low, Medium, High): ", 
+        "Invalid priority. Please enter Low, Medium, or High.", 
+        isValidPriority);
+
+    NewBug bug{ title, description, Priority::Low };
+    parsePriority(priority, bug.priority);
+    if (repository.add(bug)) {
+        cout << "Bug added.\n";
+    }
 }
 
+// Default number of bugs shown per page by listBugs()
+const int DEFAULT_LIST_PAGE_SIZE = 20;
+
+// Largest --page-size accepted
+const int MAX_LIST_PAGE_SIZE = 100000;
+
+// Number of bugs shown per page by listBugs(), set with --page-size
+int listPageSize = DEFAULT_LIST_PAGE_SIZE;
+
+// Writer used for all bug listings, format set with --format
+OutputWriter output(cout);
+
 /**
- * Validates if a title meets the requirements
- * @param title The title to validate
- * @return true if title is valid (not empty and <= 100 chars), false otherwise
+ * Prints one page of bugs using keyset pagination
+ * @param repository The open bug repository
+ * @param afterId Only bugs with an ID greater than this are listed
+ * @param pageSize Maximum number of bugs to list
+ * @param lastId Receives the ID of the last bug printed, the cursor for the next page
+ * @return Number of bugs printed, or -1 on error
  */
-bool isValidTitle(const string& title) {
-    return !title.empty() && title.length() <= 100;
+int listBugsPage(BugRepository& repository, sqlite3_int64 afterId, int pageSize, sqlite3_int64& lastId) {
+    return repository.visitPage(afterId, pageSize, lastId, writeRowVisitor, &output);
 }
 
 /**
- * Validates if a description meets the requirements
- * @param description The description to validate
- * @return true if description is valid (not empty and <= 1000 chars), false otherwise
+ * Lists the bugs in the database one page at a time
+ * Each page is written in one go; after each full page the user can press Enter for the next page or q to stop
+ * @param repository The open bug repository
  */
-bool isValidDescription(const string& description) {
-    return !description.empty() && description.length() <= 1000;
+void listBugs(BugRepository& repository) {
+    sqlite3_int64 cursor = 0;
+    string answer;
+    output.beginResult();
+    while (true) {
+        int count = listBugsPage(repository, cursor, listPageSize, cursor);
+        output.flush();
+        if (count < listPageSize) {
+            break;
+        }
+        cout << "Press Enter for the next page, or q to stop: ";
+        if (!getline(cin, answer) || answer == "q" || answer == "Q") {
+            break;
+        }
+    }
 }
 
 /**
- * Validates if a priority value is valid
- * @param priority The priority to validate
- * @return true if priority is "low", "medium", or "high" (case-insensitive), false otherwise
+ * Updates the status of an existing bug
+ * Validates the bug ID and new status
+ * @param repository The open bug repository
  */
-bool isValidPriority(const string& priority) {
-    string lowerPriority = priority;
-    transform(lowerPriority.begin(), lowerPriority.end(), lowerPriority.begin(), ::tolower);
-    return lowerPriority == "low" || lowerPriority == "medium" || lowerPriority == "high";
+void updateBug(BugRepository& repository) {
+    BugId id = getValidBugId("Bug ID to update: ");
+    
+    string newStatus = getValidInput("New Status (Open/In Progress/Resolved): ", 
+        "Invalid status. Please enter Open, In Progress, or Resolved.", 
+        isValidStatus);
+
+    Status status = Status::Open;
+    parseStatus(newStatus, status);
+    MutationResult result = repository.updateStatus(id, status);
+    if (result == MutationResult::Done) {
+        cout << "Bug updated.\n";
+    } else if (result == MutationResult::NotFound) {
+        cout << "Error: Bug with ID " << id.value << " does not exist.\n";
+    }
 }
 
 /**
- * Validates if a status value is valid
- * @param status The status to validate
- * @return true if status is "open", "in progress", or "resolved" (case-insensitive), false otherwise
+ * Deletes a bug from the database
+ * Validates the bug ID and reports if no bug has it
+ * @param repository The open bug repository
  */
-bool isValidStatus(const string& status) {
-    string lowerStatus = status;
-    transform(lowerStatus.begin(), lowerStatus.end(), lowerStatus.begin(), ::tolower);
-    return lowerStatus == "open" || lowerStatus == "in progress" || lowerStatus == "resolved";
+void deleteBug(BugRepository& repository) {
+    BugId id = getValidBugId("Bug ID to delete: ");
+
+    MutationResult result = repository.remove(id);
+    if (result == MutationResult::Done) {
+        cout << "Bug deleted.\n";
+    } else if (result == MutationResult::NotFound) {
+        cout << "Error: Bug with ID " << id.value << " does not exist.\n";
+    }
 }
 
+// Number of matches shown by searchBugs() and, unless --limit says otherwise, the search subcommand
+const int SEARCH_RESULT_LIMIT = 20;
+
 /**
- * Validates if a bug ID is a valid positive integer
- * @param id The ID to validate
- * @return true if ID is a positive integer, false otherwise
+ * Prints the best full-text matches for the given words
+ * @param repository The open bug repository
+ * @param terms Words that must all appear in the title or description; a trailing * matches a prefix
+ * @return false if the search failed, true otherwise
  */
-bool isValidBugId(const string& id) {
-    regex idPattern("^[1-9][0-9]*$");
-    return regex_match(id, idPattern);
+bool printSearchResults(BugRepository& repository, const string& terms) {
+    output.beginResult();
+    int count = repository.search(terms, SEARCH_RESULT_LIMIT, writeRowVisitor, &output);
+    output.flush();
+    if (count == 0) {
+        cout << "No bugs match.\n";
+    }
+    return count >= 0;
 }
 
 /**
- * Generic input validation function that keeps prompting until valid input is received
- * @param prompt The prompt to display to the user
- * @param errorMsg The error message to display for invalid input
- * @param validator Function pointer to the validation function to use
- * @return The validated input string
+ * Searches titles and descriptions, best matches first
+ * Prompts for the search words and shows up to SEARCH_RESULT_LIMIT bugs with the matched words highlighted
+ * @param repository The open bug repository
  */
-string getValidInput(const string& prompt, const string& errorMsg, bool (*validator)(const string&)) {
-    string input;
+void searchBugs(BugRepository& repository) {
+    string terms;
+    cout << "Search for: ";
+    getline(cin, terms);
+    printSearchResults(repository, terms);
+}
+
+/**
+ * Prints the number of bugs per status and priority as a table with row and column totals
+ * Reads the trigger-maintained summary, so it costs the same for ten bugs or ten million.
+ * @param repository The open bug repository
+ * @return false if the counts could not be read, true otherwise
+ */
+bool printStats(BugRepository& repository) {
+    BugCounts counts;
+    if (!repository.counts(counts)) {
+        return false;
+    }
+
+    cout << left << setw(12) << "Status" << right;
+    for (const char* priority : PRIORITY_NAMES) {
+        cout << setw(10) << priority;
+    }
+    cout << setw(10) << "Total" << "\n";
+
+    array<long long, size(PRIORITY_NAMES)> columnTotals = {};
+    long long total = 0;
+    for (size_t status = 0; status < counts.size(); status++) {
+        long long rowTotal = 0;
+        cout << left << setw(12) << STATUS_NAMES[status] << right;
+        for (size_t priority = 0; priority < counts[status].size(); priority++) {
+            long long count = counts[status][priority];
+            cout << setw(10) << count;
+            rowTotal += count;
+            columnTotals[priority] += count;
+        }
+        cout << setw(10) << rowTotal << "\n";
+        total += rowTotal;
+    }
+    cout << left << setw(12) << "Total" << right;
+    for (long long count : columnTotals) {
+        cout << setw(10) << count;
+    }
+    cout << setw(10) << total << endl;
+    return true;
+}
+
+// Milliseconds per day, the unit of --time-to-resolve windows
+const long long MS_PER_DAY = 86400000;
+
+// Longest window --time-to-resolve accepts, in days
+const int MAX_RESOLVE_DAYS = 1000000;
+
+/**
+ * Formats a duration as its two largest units, e.g. "3d 4h", "5h 12m" or "42s"
+ * @param ms Duration in milliseconds
+ */
+string formatDuration(double ms) {
+    long long seconds = static_cast<long long>(ms / 1000 + 0.5);
+    long long days = seconds / 86400;
+    long long hours = seconds / 3600 % 24;
+    long long minutes = seconds / 60 % 60;
+    if (days > 0) return to_string(days) + "d " + to_string(hours) + "h";
+    if (hours > 0) return to_string(hours) + "h " + to_string(minutes) + "m";
+    if (minutes > 0) return to_string(minutes) + "m " + to_string(seconds % 60) + "s";
+    return to_string(seconds) + "s";
+}
+
+/**
+ * Prints how many bugs were resolved in a window and the mean time from filing to resolution
+ * @param repository The open bug repository
+ * @param days Length of the window ending now, 0 for all time
+ * @return false if the history could not be read, true otherwise
+ */
+bool printTimeToResolve(BugRepository& repository, int days) {
+    long long now = currentTimeMs();
+    ResolveStats stats;
+    if (!repository.timeToResolve(days > 0 ? now - days * MS_PER_DAY : 0, now + 1, stats)) {
+        return false;
+    }
+    cout << "Resolved " << (days > 0 ? "in the last " + to_string(days) + " days" : "all time") << ": "
+        << stats.resolved;
+    if (stats.resolved > 0) {
+        cout << ", mean time to resolve " << formatDuration(stats.meanMs);
+    }
+    cout << endl;
+    return true;
+}
+
+/**
+ * Prints the bugs not yet resolved grouped by age, with the mean and oldest age per group
+ * @param repository The open bug repository
+ * @return false if the history could not be read, true otherwise
+ */
+bool printAging(BugRepository& repository) {
+    BugAging aging;
+    if (!repository.openBugAging(currentTimeMs(), aging)) {
+        return false;
+    }
+    cout << left << setw(12) << "Age" << right << setw(10) << "Bugs" << setw(12) << "Mean age" << setw(12) << "Oldest" << "\n";
+    for (size_t i = 0; i < aging.size(); i++) {
+        cout << left << setw(12) << AGING_BUCKET_NAMES[i] << right << setw(10) << aging[i].bugs;
+        if (aging[i].bugs > 0) {
+            cout << setw(12) << formatDuration(aging[i].meanAgeMs) << setw(12) << formatDuration(static_cast<double>(aging[i].maxAgeMs));
+        }
+        cout << "\n";
+    }
+    cout.flush();
+    return true;
+}
+
+/**
+ * Shows the status/priority counts, resolution time over the last 30 days and open bug aging
+ * @param repository The open bug repository
+ */
+void showStatistics(BugRepository& repository) {
+    if (printStats(repository)) {
+        cout << "\n";
+        printTimeToResolve(repository, 30);
+        cout << "\n";
+        printAging(repository);
+    }
+}
+
+/**
+ * A subcommand and its arguments, from the command line or from one line of --stdin-batch input
+ *   add --title <text> --description <text> --priority <Low|Medium|High>
+ *   get <id>
+ *   list [--status <s>] [--priority <p>] [--since <time>] [--until <time>] [--title-prefix <text>]
+ *        [--after <id> [--after-created <time>]] [--limit <n>]
+ *   update <id> --status <Open|In Progress|Resolved>
+ *   delete <id>
+ *   search <words> [--limit <n>]
+ *   export --out <dir> [--threads <n>]
+ */
+struct Command {
+    string name;
+    vector<string> operands;    // Words after the name that are not flags, i.e. the bug ID or the search words
+    string title;
+    string description;
+    string priority;
+    string status;
+    string after;
+    string afterCreated;
+    string limit;
+    string since;
+    string until;
+    string titlePrefix;
+    string threads;
+    string out;
+};
+
+// Flags taken by subcommands; every one of them is followed by a value
+const char* const COMMAND_FLAGS[] = {
+    "--title", "--description", "--priority", "--status", "--after", "--after-created", "--limit", "--since", "--until",
+    "--title-prefix", "--threads", "--out"
+};
+
+// Bugs read per statement by the list subcommand
+const int COMMAND_LIST_PAGE_SIZE = 1000;
+
+// Largest --limit the list and search subcommands accept
+const long long MAX_LIST_LIMIT = 1000000000;
+
+/**
+ * Checks if an argument is one of the subcommand flags
+ */
+bool isCommandFlag(const string& arg) {
+    return find_if(begin(COMMAND_FLAGS), end(COMMAND_FLAGS),
+        [&arg](const char* flag) { return arg == flag; }) != end(COMMAND_FLAGS);
+}
+
+/**
+ * Parses a count given to a flag, such as --limit, --threads or --port
+ * Accepts only decimal digits, with no sign or whitespace
+ * @param text The text to parse
+ * @param lowest Smallest count accepted
+ * @param highest Largest count accepted
+ * @param count Receives the parsed count
+ * @return true if text is a count between lowest and highest, false otherwise
+ */
+bool parseCount(const string& text, long long lowest, long long highest, long long& count) {
+    long long value;
+    const char* end = text.data() + text.size();
+    auto result = from_chars(text.data(), end, value);
+    if (text.empty() || text[0] == '-' || result.ec != errc() || result.ptr != end || value < lowest || value > highest) {
+        return false;
+    }
+    count = value;
+    return true;
+}
+
+/**
+ * Parses the words of a subcommand: its name, then operands and flags in any order
+ * Flags are given as "--flag value" or "--flag=value".
+ * @param words The words, e.g. { "update", "42", "--status", "Resolved" }
+ * @param command Receives the parsed command
+ * @param error Receives the reason if the words are not a command
+ * @return true if every word was understood, false otherwise
+ */
+bool parseCommand(const vector<string>& words, Command& command, string& error) {
+    command = Command();
+    for (size_t i = 0; i < words.size(); i++) {
+        string word = words[i];
+        if (word.compare(0, 2, "--") != 0) {
+            if (command.name.empty()) command.name = word;
+            else command.operands.push_back(word);
+            continue;
+        }
+
+        string value;
+        size_t eq = word.find('=');
+        if (eq != string::npos) {
+            value = word.substr(eq + 1);
+            word.resize(eq);
+        } else if (i + 1 < words.size()) {
+            value = words[++i];
+        } else {
+            error = word + " needs a value";
+            return false;
+        }
+        if (word == "--title") command.title = value;
+        else if (word == "--description") command.description = value;
+        else if (word == "--priority") command.priority = value;
+        else if (word == "--status") command.status = value;
+        else if (word == "--after") command.after = value;
+        else if (word == "--after-created") command.afterCreated = value;
+        else if (word == "--limit") command.limit = value;
+        else if (word == "--since") command.since = value;
+        else if (word == "--until") command.until = value;
+        else if (word == "--title-prefix") command.titlePrefix = value;
+        else if (word == "--threads") command.threads = value;
+        else if (word == "--out") command.out = value;
+        else {
+            error = "unknown flag " + word;
+            return false;
+        }
+    }
+    if (command.name.empty()) {
+        error = "no command given (expected add, get, list, search, update, delete or export)";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Splits one line of --stdin-batch input into words the way a shell would
+ * Words are separated by spaces or tabs. "Double" and 'single' quotes keep spaces inside a word;
+ * a backslash takes the next character literally, except inside single quotes.
+ * @param line The line to split
+ * @param words Receives the words
+ * @return false if a quote is left open, true otherwise
+ */
+bool splitWords(const string& line, vector<string>& words) {
+    words.clear();
+    string word;
+    bool inWord = false;
+    char quote = 0;
+    for (size_t i = 0; i < line.size(); i++) {
+        char c = line[i];
+        if (quote) {
+            if (c == quote) quote = 0;
+            else if (c == '\\' && quote == '"' && i + 1 < line.size()) word.push_back(line[++i]);
+            else word.push_back(c);
+        } else if (c == '"' || c == '\'') {
+            quote = c;
+            inWord = true;
+        } else if (c == '\\' && i + 1 < line.size()) {
+            word.push_back(line[++i]);
+            inWord = true;
+        } else if (c == ' ' || c == '\t' || c == '\r') {
+            if (inWord) {
+                words.push_back(word);
+                word.clear();
+                inWord = false;
+            }
+        } else {
+            word.push_back(c);
+            inWord = true;
+        }
+    }
+    if (inWord) {
+        words.push_back(word);
+    }
+    return quote == 0;
+}
+
+/**
+ * Writes the outcome of a subcommand that returns no bugs as one record with the columns Command, ID and Result
+ * @param command The command
+ * @param id The bug it added or changed, nothing if there is none
+ * @param result added, updated, deleted, not found, invalid or failed
+ */
+void writeCommandResult(const Command& command, optional<BugId> id, const char* result) {
+    static const char* const names[] = { "Command", "ID", "Result" };
+    const string values[] = { command.name, id ? to_string(id->value) : string(), result };
+    const int types[] = { SQLITE_TEXT, id ? SQLITE_INTEGER : SQLITE_NULL, SQLITE_TEXT };
+    output.writeValues(names, values, types, static_cast<int>(size(names)));
+}
+
+/**
+ * Runs the list subcommand
+ * Without predicates it pages through all bugs in ID order. With any of --status, --priority, --since,
+ * --until or --title-prefix it runs one filtered query that streams the matching bugs in filing order.
+ * --after and --limit page through either listing. A filtered listing continues after the bug given by --after in
+ * filing order, which takes its Created time from --after-created, or from the bug itself if that is not given.
+ * @return true if the listing succeeded, false on invalid flags or a database error
+ */
+bool runListCommand(BugRepository& repository, const Command& command) {
+    auto invalid = [&command](const string& message) {
+        cerr << "list: " << message << endl;
+        writeCommandResult(command, nullopt, "invalid");
+        return false;
+    };
+
+    BugId after{ 0 };
+    long long limit = numeric_limits<long long>::max();
+    if (!command.after.empty() && !parseBugId(command.after, after)) {
+        return invalid("--after must be a bug ID");
+    }
+    if (!command.limit.empty() && !parseCount(command.limit, 1, MAX_LIST_LIMIT, limit)) {
+        return invalid("--limit must be between 1 and " + to_string(MAX_LIST_LIMIT));
+    }
+
+    bool filtered = !command.status.empty() || !command.priority.empty() || !command.since.empty() ||
+        !command.until.empty() || !command.titlePrefix.empty();
+    if (!command.afterCreated.empty() && (command.after.empty() || !filtered)) {
+        return invalid("--after-created goes with --after in a filtered listing");
+    }
+
+    if (filtered) {
+        BugFilter filter;
+        Status status;
+        Priority priority;
+        sqlite3_int64 ms;
+        if (!command.status.empty()) {
+            if (!parseStatus(command.status, status)) return invalid("--status must be Open, In Progress or Resolved");
+            filter.status = status;
+        }
+        if (!command.priority.empty()) {
+            if (!parsePriority(command.priority, priority)) return invalid("--priority must be Low, Medium or High");
+            filter.priority = priority;
+        }
+        for (auto [text, bound] : { make_pair(&command.since, &filter.sinceMs), make_pair(&command.until, &filter.untilMs) }) {
+            if (text->empty()) continue;
+            if (!parseTimestamp(*text, ms)) {
+                return invalid("--since and --until take epoch milliseconds or a UTC date such as 2025-01-31 or 2025-01-31T12:00");
+            }
+            *bound = ms;
+        }
+        filter.titlePrefix = command.titlePrefix;
+        if (!command.after.empty()) {
+            FilterCursor cursor{ 0, after.value };
+            if (!command.afterCreated.empty()) {
+                if (!parseTimestamp(command.afterCreated, cursor.created)) {
+                    return invalid("--after-created takes epoch milliseconds or a UTC date");
+                }
+            } else if (optional<Bug> last = repository.get(after)) {
+                cursor.created = last->created;
+            } else {
+                return invalid("--after names no bug; give the Created time of the last bug listed with --after-created");
+            }
+            filter.after = cursor;
+        }
+        filter.limit = command.limit.empty() ? 0 : limit;
+        return repository.visitFiltered(filter, writeRowVisitor, &output) >= 0;
+    }
+
+    sqlite3_int64 cursor = after.value;
+    long long remaining = limit;
+    while (remaining > 0) {
+        int pageSize = static_cast<int>(min<long long>(remaining, COMMAND_LIST_PAGE_SIZE));
+        int count = repository.visitPage(cursor, pageSize, cursor, writeRowVisitor, &output);
+        if (count < 0) {
+            return false;
+        }
+        if (count < pageSize) {
+            break;
+        }
+        remaining -= count;
+    }
+    return true;
+}
+
+/**
+ * Runs the search subcommand: the best full-text matches for its words, SEARCH_RESULT_LIMIT unless --limit is given
+ * Rows have the same columns as the --search option and the menu's search.
+ * @return true if the search ran, even if nothing matched; false on invalid flags or a database error
+ */
+bool runSearchCommand(BugRepository& repository, const Command& command) {
+    auto invalid = [&command](const string& message) {
+        cerr << "search: " << message << endl;
+        writeCommandResult(command, nullopt, "invalid");
+        return false;
+    };
+
+    long long limit = SEARCH_RESULT_LIMIT;
+    if (!command.limit.empty() && !parseCount(command.limit, 1, MAX_LIST_LIMIT, limit)) {
+        return invalid("--limit must be between 1 and " + to_string(MAX_LIST_LIMIT));
+    }
+    string terms;
+    for (const string& word : command.operands) {
+        if (!terms.empty()) terms.push_back(' ');
+        terms += word;
+    }
+    if (terms.find_first_not_of(" \t") == string::npos) {
+        return invalid("needs the words to search for");
+    }
+    return repository.search(terms, static_cast<int>(limit), writeRowVisitor, &output) >= 0;
+}
+
+/**
+ * Runs one subcommand and writes its result to the output writer
+ * get, list and search write bugs; the other commands, and any command that fails, write one result record.
+ * Invalid arguments are explained on stderr.
+ * @param repository The open bug repository
+ * @param command The parsed command
+ * @return true if the command succeeded, false if it was invalid, found no bug or failed
+ */
+bool runCommand(BugRepository& repository, const Command& command) {
+    output.beginResult();
+    auto invalid = [&command](const string& message) {
+        cerr << command.name << ": " << message << endl;
+        writeCommandResult(command, nullopt, "invalid");
+        return false;
+    };
+
+    const string& name = command.name;
+    if (name == "list") {
+        if (!command.operands.empty()) {
+            return invalid("unexpected argument " + command.operands[0]);
+        }
+        return runListCommand(repository, command);
+    }
+    if (name == "search") {
+        return runSearchCommand(repository, command);
+    }
+    if (name == "add") {
+        NewBug bug{ command.title, command.description, Priority::Low };
+        if (!command.operands.empty()) {
+            return invalid("unexpected argument " + command.operands[0]);
+        }
+        if (!isValidTitle(bug.title) || !isValidDescription(bug.description) ||
+            !parsePriority(command.priority, bug.priority)) {
+            return invalid("needs --title (1-100 characters), --description (1-1000 characters) "
+                "and --priority (Low, Medium or High)");
+        }
+        optional<BugId> id = repository.add(bug);
+        writeCommandResult(command, id, id ? "added" : "failed");
+        return id.has_value();
+    }
+    if (name == "export") {
+        // Needs connections of its own and a snapshot of committed data, see runExportCommand()
+        return invalid("runs on its own, not in --stdin-batch");
+    }
+    if (name != "get" && name != "update" && name != "delete") {
+        return invalid("unknown command (expected add, get, list, search, update, delete or export)");
+    }
+
+    BugId id;
+    if (command.operands.size() != 1 || !parseBugId(command.operands[0], id)) {
+        return invalid("expects one bug ID");
+    }
+    if (name == "get") {
+        optional<Bug> bug = repository.get(id);
+        if (bug) output.writeBug(*bug);
+        else writeCommandResult(command, id, "not found");
+        return bug.has_value();
+    }
+
+    bool update = name == "update";
+    Status status = Status::Open;
+    if (update && !parseStatus(command.status, status)) {
+        return invalid("needs --status (Open, In Progress or Resolved)");
+    }
+    MutationResult result = update ? repository.updateStatus(id, status) : repository.remove(id);
+    writeCommandResult(command, id, result == MutationResult::Done ? (update ? "updated" : "deleted") :
+        result == MutationResult::NotFound ? "not found" : "failed");
+    return result == MutationResult::Done;
+}
+
+/**
+ * Runs one subcommand per input line on one connection and in one transaction, writing each result in order
+ * Blank lines and lines starting with # are skipped. Each add, update or delete runs in its own savepoint, so a
+ * command that fails is reported, leaves nothing behind and the rest still run; everything that succeeded is
+ * committed together at the end, so thousands of commands cost one commit.
+ * @param repository The open bug repository
+ * @param in The commands, e.g. lines like: update 42 --status "In Progress"
+ * @return true if every command succeeded and the transaction committed, false otherwise
+ */
+bool runBatch(BugRepository& repository, istream& in) {
+    // IMMEDIATE takes the write lock up front, so a later write in the batch cannot fail on a lock upgrade
+    if (!repository.execute("BEGIN IMMEDIATE;")) {
+        return false;
+    }
+
+    string line;
+    vector<string> words;
+    Command command;
+    string error;
+    size_t lineNumber = 0;
+    size_t succeeded = 0;
+    size_t failed = 0;
+    bool aborted = false;
+    while (getline(in, line)) {
+        lineNumber++;
+        size_t first = line.find_first_not_of(" \t\r");
+        if (first == string::npos || line[first] == '#') {
+            continue;
+        }
+        if (!splitWords(line, words)) {
+            command = Command();
+            error = "unclosed quote";
+        }
+        if (!error.empty() || !parseCommand(words, command, error)) {
+            cerr << "Line " << lineNumber << ": " << error << endl;
+            error.clear();
+            output.beginResult();
+            writeCommandResult(command, nullopt, "invalid");
+            failed++;
+            continue;
+        }
+        // A savepoint per write, so a command that fails halfway (add() writes several tables) leaves nothing behind
+        bool writes = command.name == "add" || command.name == "update" || command.name == "delete";
+        if (writes && !repository.execute("SAVEPOINT line;")) {
+            aborted = true;
+            break;
+        }
+        bool ok = runCommand(repository, command);
+        if (writes && ((!ok && !repository.execute("ROLLBACK TO line;")) || !repository.execute("RELEASE line;"))) {
+            aborted = true;
+            break;
+        }
+        if (ok) succeeded++;
+        else failed++;
+    }
+    output.flush();
+
+    bool committed = !aborted && repository.execute("COMMIT;");
+    if (!committed) {
+        repository.execute("ROLLBACK;");
+    }
+    cerr << "Batch: " << succeeded << " commands succeeded, " << failed << " failed"
+        << (committed ? "" : "; nothing was committed") << endl;
+    return committed && failed == 0;
+}
+
+/**
+ * Runs the export subcommand, see exportBugs()
+ * @param repository The open bug repository, outside any transaction
+ * @param command The command, with --out and optionally --threads (default: one per core)
+ * @param profile Connection settings for the shard connections
+ * @return true if every file was written, false on invalid flags or any error
+ */
+bool runExportCommand(BugRepository& repository, const Command& command, const PragmaProfile& profile) {
+    output.beginResult();
+    auto invalid = [&command](const string& message) {
+        cerr << "export: " << message << endl;
+        writeCommandResult(command, nullopt, "invalid");
+        return false;
+    };
+
+    int threads = max(1u, thread::hardware_concurrency());
+    if (!command.threads.empty()) {
+        long long count;
+        if (!parseCount(command.threads, 1, MAX_EXPORT_THREADS, count)) {
+            return invalid("--threads must be between 1 and " + to_string(MAX_EXPORT_THREADS));
+        }
+        threads = static_cast<int>(count);
+    }
+    if (!command.operands.empty()) {
+        return invalid("unexpected argument " + command.operands[0]);
+    }
+    if (command.out.empty()) {
+        return invalid("needs --out <directory>");
+    }
+    OutputFormat format = output.getFormat();
+    if (format == OutputFormat::Table) {
+        return invalid("writes csv or ndjson, not table");
+    }
+    error_code error;
+    filesystem::create_directories(command.out, error);
+    if (error) {
+        cerr << "Can't create " << command.out << ": " << error.message() << endl;
+        writeCommandResult(command, nullopt, "failed");
+        return false;
+    }
+
+    auto start = chrono::steady_clock::now();
+    long long rows = 0;
+    bool ok = exportBugs(repository, command.out, threads, format, profile, rows);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    if (ok) {
+        cerr << "Exported " << rows << " bugs to " << threads << " files in " << command.out << " in "
+            << fixed << setprecision(2) << seconds << " s (" << static_cast<long long>(rows / seconds) << " bugs/sec)"
+            << defaultfloat << endl;
+    }
+    writeCommandResult(command, nullopt, ok ? "exported" : "failed");
+    return ok;
+}
+
+// Number of imported rows committed per transaction
+const size_t IMPORT_BATCH_SIZE = 100000;
+
+// Number of imported rows covered by one savepoint; a failed insert replays its chunk a row at a time
+const size_t IMPORT_CHUNK_SIZE = 1000;
+
+/**
+ * A single bug record read from an import file
+ */
+struct ImportRecord {
+    string title;
+    string description;
+    string priority;
+};
+
+/**
+ * Reads one CSV record, following quoted fields across line breaks
+ * Supports "" as an escaped quote inside quoted fields
+ * @param in The stream to read from
+ * @param line Reusable line buffer
+ * @param fields Receives the fields of the record
+ * @param lineNumber Incremented for every physical line consumed
+ * @return false at end of input, true otherwise
+ */
+bool readCsvRecord(istream& in, string& line, vector<string>& fields, size_t& lineNumber) {
+    if (!getline(in, line)) {
+        return false;
+    }
+    lineNumber++;
+    fields.clear();
+    fields.emplace_back();
+
+    bool quoted = false;
+    size_t i = 0;
     while (true) {
-        cout << prompt;
-        getline(cin, input);
-        if (validator(input)) {
-            return input;
+        if (i == line.size()) {
+            if (!quoted || !getline(in, line)) {
+                break;
+            }
+            lineNumber++;
+            fields.back().push_back('\n');
+            i = 0;
+            continue;
+        }
+
+        char c = line[i++];
+        if (quoted) {
+            if (c != '"') {
+                fields.back().push_back(c);
+            } else if (i < line.size() && line[i] == '"') {
+                fields.back().push_back('"');
+                i++;
+            } else {
+                quoted = false;
+            }
+        } else if (c == '"') {
+            quoted = true;
+        } else if (c == ',') {
+            fields.emplace_back();
+        } else if (c != '\r') {
+            fields.back().push_back(c);
         }
-        cout << errorMsg << endl;
     }
+    return true;
 }
 
 /**
- * Checks if a bug with the given ID exists in the database
- * @param id The bug ID to check
- * @return true if the bug exists, false otherwise
+ * Parses one NDJSON line into an import record
+ * Only the title, description and priority keys are used; other keys are ignored
+ * @param line A single JSON object
+ * @param record Receives the parsed values
+ * @return true if the line is a well-formed flat JSON object, false otherwise
  */
-bool bugExists(const string& id) {
-    sqlite3_stmt* stmt;
-    const char* sql = "SELECT COUNT(*) FROM bugs WHERE ID = ?;";
-    
-    int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr);
-    if (rc != SQLITE_OK) {
-        cerr << "Failed to prepare statement: " << sqlite3_errmsg(db) << endl;
+bool parseNdjsonRecord(const string& line, ImportRecord& record) {
+    record.title.clear();
+    record.description.clear();
+    record.priority.clear();
+
+    JsonFields fields;
+    if (!parseJsonObject(line, fields)) {
         return false;
     }
+    for (auto& field : fields) {
+        string& key = field.first;
+        transform(key.begin(), key.end(), key.begin(), ::tolower);
+        if (key == "title") record.title.swap(field.second);
+        else if (key == "description") record.description.swap(field.second);
+        else if (key == "priority") record.priority.swap(field.second);
+    }
+    return true;
+}
 
-    sqlite3_bind_text(stmt, 1, id.c_str(), -1, SQLITE_TRANSIENT);
-    
-    bool exists = false;
-    if (sqlite3_step(stmt) == SQLITE_ROW) {
-        exists = sqlite3_column_int(stmt, 0) > 0;
+/**
+ * Checks if a path ends with the given extension (case-insensitive)
+ * @param path The file path
+ * @param extension The extension including the leading dot
+ * @return true if the path has the extension, false otherwise
+ */
+bool hasExtension(const string& path, const string& extension) {
+    if (path.length() < extension.length()) {
+        return false;
     }
-    
-    sqlite3_finalize(stmt);
-    return exists;
+    string tail = path.substr(path.length() - extension.length());
+    transform(tail.begin(), tail.end(), tail.begin(), ::tolower);
+    return tail == extension;
 }
 
 /**
- * Adds a new bug to the database
- * Prompts for and validates title, description, and priority
- * Uses parameterized queries to prevent SQL injection
+ * Imports bugs from a CSV or NDJSON file without prompting
+ * Every record goes through the same validators as addBug(); invalid records are reported and skipped.
+ * Rows are inserted with one reused INSERT statement inside explicit transactions of IMPORT_BATCH_SIZE rows.
+ * Every IMPORT_CHUNK_SIZE rows share a savepoint. When an insert fails, the chunk is rolled back and its earlier
+ * rows are added again each in a savepoint of its own, so a failed row leaves nothing behind without paying for
+ * a savepoint per row (each savepoint flushes the full-text index's pending terms).
+ * CSV files may start with a header naming the Title, Description and Priority columns;
+ * otherwise the columns are taken in that order. Files ending in .ndjson, .jsonl or .json are read as NDJSON.
+ * @param repository The open bug repository
+ * @param path Path of the file to import
+ * @return true if the import ran to completion, false if the file or a transaction failed
  */
-void addBug() {
-    string title = getValidInput("Title: ", 
-        "Invalid title. Title must not be empty and must be less than 100 characters.", 
-        isValidTitle);
-    
-    string description = getValidInput("Description: ", 
-        "Invalid description. Description must not be empty and must be less than 1000 characters.", 
-        isValidDescription);
-    
-    string priority = getValidInput("Priority (Low, Medium, High): ", 
-        "Invalid priority. Please enter Low, Medium, or High.", 
-        isValidPriority);
+bool importBugs(BugRepository& repository, const string& path) {
+    vector<char> buffer(1 << 20);
+    ifstream in;
+    in.rdbuf()->pubsetbuf(buffer.data(), buffer.size());
+    in.open(path, ios::binary);
+    if (!in) {
+        cerr << "Can't open import file: " << path << endl;
+        return false;
+    }
 
-    sqlite3_stmt* stmt;
-    const char* sql = "INSERT INTO bugs (Title, Description, Priority) VALUES (?, ?, ?);";
-    
-    int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr);
-    if (rc != SQLITE_OK) {
-        cerr << "Failed to prepare statement: " << sqlite3_errmsg(db) << endl;
-        return;
+    bool ndjson = hasExtension(path, ".ndjson") || hasExtension(path, ".jsonl") || hasExtension(path, ".json");
+    size_t titleColumn = 0, descriptionColumn = 1, priorityColumn = 2;
+    bool firstRecord = true;
+
+    string line;
+    vector<string> fields;
+    ImportRecord record;
+    size_t lineNumber = 0;
+    size_t imported = 0;
+    size_t skipped = 0;
+    size_t inBatch = 0;
+
+    // Records added since the chunk savepoint, with their line numbers, kept until the savepoint is released
+    vector<pair<size_t, NewBug>> chunk;
+    chunk.reserve(IMPORT_CHUNK_SIZE);
+    auto fail = [&repository]() {
+        repository.execute("ROLLBACK;");
+        return false;
+    };
+    auto releaseChunk = [&repository, &chunk]() {
+        if (chunk.empty()) {
+            return true;
+        }
+        chunk.clear();
+        return repository.execute("RELEASE chunk;");
+    };
+    auto replayChunk = [&]() {
+        for (const auto& [addedLine, bug] : chunk) {
+            if (!repository.execute("SAVEPOINT record;")) {
+                return false;
+            }
+            bool added = repository.add(bug).has_value();
+            if ((!added && !repository.execute("ROLLBACK TO record;")) || !repository.execute("RELEASE record;")) {
+                return false;
+            }
+            if (!added) {
+                cerr << "Line " << addedLine << ": insert failed, skipped.\n";
+                imported--;
+                skipped++;
+            }
+        }
+        chunk.clear();
+        return true;
+    };
+
+    auto start = chrono::steady_clock::now();
+    if (!repository.execute("BEGIN;")) {
+        return false;
     }
 
-    sqlite3_bind_text(stmt, 1, title.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 2, description.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 3, priority.c_str(), -1, SQLITE_TRANSIENT);
+    while (true) {
+        size_t recordLine = lineNumber + 1;
+        if (ndjson) {
+            if (!getline(in, line)) break;
+            lineNumber++;
+            if (line.find_first_not_of(" \t\r") == string::npos) continue;
+            if (!parseNdjsonRecord(line, record)) {
+                cerr << "Line " << recordLine << ": malformed JSON record, skipped.\n";
+                skipped++;
+                continue;
+            }
+        } else {
+            if (!readCsvRecord(in, line, fields, lineNumber)) break;
+            if (fields.size() == 1 && fields[0].empty()) continue;
 
-    rc = sqlite3_step(stmt);
-    if (rc != SQLITE_DONE) {
-        cerr << "Failed to insert bug: " << sqlite3_errmsg(db) << endl;
-    } else {
-        cout << "Bug added.\n";
+            if (firstRecord) {
+                firstRecord = false;
+                string first = fields[0];
+                transform(first.begin(), first.end(), first.begin(), ::tolower);
+                if (first == "title" || first == "description" || first == "priority") {
+                    for (size_t i = 0; i < fields.size(); i++) {
+                        string name = fields[i];
+                        transform(name.begin(), name.end(), name.begin(), ::tolower);
+                        if (name == "title") titleColumn = i;
+                        else if (name == "description") descriptionColumn = i;
+                        else if (name == "priority") priorityColumn = i;
+                    }
+                    continue;
+                }
+            }
+
+            size_t needed = max(titleColumn, max(descriptionColumn, priorityColumn)) + 1;
+            if (fields.size() < needed) {
+                cerr << "Line " << recordLine << ": expected " << needed << " columns, skipped.\n";
+                skipped++;
+                continue;
+            }
+            record.title.swap(fields[titleColumn]);
+            record.description.swap(fields[descriptionColumn]);
+            record.priority.swap(fields[priorityColumn]);
+        }
+
+        if (!isValidTitle(record.title) || !isValidDescription(record.description) ||
+            !isValidPriority(record.priority)) {
+            cerr << "Line " << recordLine << ": invalid title, description or priority, skipped.\n";
+            skipped++;
+            continue;
+        }
+
+        NewBug bug{ record.title, record.description, Priority::Low };
+        parsePriority(record.priority, bug.priority);
+        if (chunk.empty() && !repository.execute("SAVEPOINT chunk;")) {
+            return fail();
+        }
+        if (repository.add(bug)) {
+            chunk.emplace_back(recordLine, move(bug));
+            imported++;
+        } else {
+            // add() writes several tables, so drop whatever this chunk left behind and add its
+            // earlier records again one savepoint at a time
+            cerr << "Line " << recordLine << ": insert failed, skipped.\n";
+            skipped++;
+            if (!repository.execute("ROLLBACK TO chunk;") || !repository.execute("RELEASE chunk;") ||
+                !replayChunk()) {
+                return fail();
+            }
+        }
+        if (chunk.size() == IMPORT_CHUNK_SIZE && !releaseChunk()) {
+            return fail();
+        }
+
+        if (++inBatch == IMPORT_BATCH_SIZE) {
+            if (!releaseChunk() || !repository.execute("COMMIT;") || !repository.execute("BEGIN;")) {
+                return false;
+            }
+            inBatch = 0;
+        }
+    }
+
+    if (!releaseChunk() || !repository.execute("COMMIT;")) {
+        return false;
     }
 
-    sqlite3_finalize(stmt);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << "Imported " << imported << " bugs (" << skipped << " skipped) in " << seconds << " s";
+    if (seconds > 0) {
+        cout << " (" << static_cast<long long>(imported / seconds) << " rows/sec)";
+    }
+    cout << ".\n";
+    return true;
 }
 
 /**
- * Callback function for SQLite queries that prints each row of results
- * @param NotUsed Unused parameter required by SQLite
- * @param argc Number of columns in the result
- * @param argv Array of column values
- * @param azColName Array of column names
- * @return 0 to continue query execution
+ * Legacy row printer kept as the baseline for benchmarkOutput()
+ * Writes each column with endl, flushing the stream once per field
  */
-int callback(void* NotUsed, int argc, char** argv, char** azColName) {
+int legacyPrintCallback(void*, int argc, char** argv, char** azColName) {
     for (int i = 0; i < argc; i++)
         cout << azColName[i] << ": " << (argv[i] ? argv[i] : "NULL") << endl;
     cout << "------------------------\n";
@@ -193,128 +1076,459 @@ int callback(void* NotUsed, int argc, char** argv, char** azColName) {
 }
 
 /**
- * Lists all bugs in the database
- * Uses the callback function to display each bug's details
+ * Measures listing throughput of the legacy printer against OutputWriter in every format
+ * Fills the (in-memory) database with the requested number of rows and lists it to stdout;
+ * results are reported on stderr, so run with stdout redirected to a file or /dev/null
+ * @param repository An open, empty repository
+ * @param rows Number of rows to generate and list
  */
-void listBugs() {
-    string sql = "SELECT * FROM bugs;";
-    sqlite3_exec(db, sql.c_str(), callback, nullptr, nullptr);
+void benchmarkOutput(BugRepository& repository, int rows) {
+    repository.execute("BEGIN;");
+    for (int i = 0; i < rows; i++) {
+        repository.add({ "Bug " + to_string(i), "Benchmark row with \"quotes\", commas and text " + to_string(i), Priority::Medium });
+    }
+    repository.execute("COMMIT;");
+
+    auto report = [rows](const string& name, chrono::steady_clock::time_point start) {
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cerr << name << ": " << static_cast<long long>(rows / seconds) << " rows/sec\n";
+    };
+
+    auto start = chrono::steady_clock::now();
+    sqlite3_exec(repository.connection(), "SELECT * FROM bugs;", legacyPrintCallback, nullptr, nullptr);
+    report("legacy callback + endl", start);
+
+    const char* names[] = { "table", "csv", "ndjson" };
+    for (const char* name : names) {
+        OutputFormat format;
+        parseOutputFormat(name, format);
+        output.setFormat(format);
+        output.beginResult();
+
+        start = chrono::steady_clock::now();
+        sqlite3_int64 cursor = 0;
+        while (listBugsPage(repository, cursor, listPageSize, cursor) == listPageSize) {
+            output.flush();
+        }
+        output.flush();
+        report(string("buffered ") + name, start);
+    }
+
+    // Decoding alone: copying each row into a Bug, as list() does, against viewing it in SQLite's row buffer
+    vector<Bug> page;
+    start = chrono::steady_clock::now();
+    size_t bytes = 0;
+    sqlite3_int64 cursor = 0;
+    while (repository.list(cursor, listPageSize, page) > 0) {
+        for (const Bug& bug : page) bytes += bug.title.size() + bug.description.size();
+        cursor = page.back().id.value;
+    }
+    report("decode into Bug", start);
+
+    start = chrono::steady_clock::now();
+    size_t viewBytes = 0;
+    cursor = 0;
+    while (repository.visitPage(cursor, listPageSize, cursor, [](sqlite3_stmt* stmt, void* context) {
+        BugView bug = readBugView(stmt);
+        *static_cast<size_t*>(context) += bug.title.size() + bug.description.size();
+    }, &viewBytes) > 0) {
+    }
+    report("decode into BugView", start);
+    if (viewBytes != bytes) cerr << "Decoded text differs: " << bytes << " bytes as Bug, " << viewBytes << " as BugView\n";
 }
 
 /**
- * Updates the status of an existing bug
- * Validates the bug ID and new status
- * Uses parameterized queries to prevent SQL injection
+ * Regex based ID validator kept as the baseline for benchmarkBugIdParsing()
+ * Builds a new std::regex on every call, as isValidBugId() used to
  */
-void updateBug() {
-    string id = getValidInput("Bug ID to update: ", 
-        "Invalid ID. Please enter a positive number.", 
-        isValidBugId);
-    
-    if (!bugExists(id)) {
-        cout << "Error: Bug with ID " << id << " does not exist.\n";
-        return;
+bool legacyIsValidBugId(const string& id) {
+    regex idPattern("^[1-9][0-9]*$");
+    return regex_match(id, idPattern);
+}
+
+/**
+ * Compares the regex ID validator with parseBugId() over a fixed mix of valid and invalid inputs
+ * @param iterations Number of IDs validated by each implementation
+ */
+void benchmarkBugIdParsing(long long iterations) {
+    const vector<string> inputs = {
+        "1", "42", "1337", "9223372036854775807", "9223372036854775808",
+        "0", "007", "-5", "12a", "", "99999999999999999999", "123456"
+    };
+
+    auto start = chrono::steady_clock::now();
+    long long accepted = 0;
+    for (long long i = 0; i < iterations; i++) {
+        accepted += legacyIsValidBugId(inputs[i % inputs.size()]);
     }
-    
-    string newStatus = getValidInput("New Status (Open/In Progress/Resolved): ", 
-        "Invalid status. Please enter Open, In Progress, or Resolved.", 
-        isValidStatus);
+    double regexSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cerr << "regex per call:   " << static_cast<long long>(iterations / regexSeconds) << " ids/sec ("
+        << accepted << " accepted)\n";
 
-    sqlite3_stmt* stmt;
-    const char* sql = "UPDATE bugs SET status = ? WHERE ID = ?;";
-    
-    int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr);
-    if (rc != SQLITE_OK) {
-        cerr << "Failed to prepare statement: " << sqlite3_errmsg(db) << endl;
-        return;
+    start = chrono::steady_clock::now();
+    accepted = 0;
+    for (long long i = 0; i < iterations; i++) {
+        BugId id;
+        accepted += parseBugId(inputs[i % inputs.size()], id);
     }
+    double parseSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cerr << "parseBugId:       " << static_cast<long long>(iterations / parseSeconds) << " ids/sec ("
+        << accepted << " accepted)\n";
+}
 
-    sqlite3_bind_text(stmt, 1, newStatus.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 2, id.c_str(), -1, SQLITE_TRANSIENT);
+/**
+ * Compares ID lookups bound as text, as bugExists() used to do, with lookups bound as int64
+ * Runs against the (in-memory) database after filling it with the requested number of rows
+ * @param repository An open, empty repository
+ * @param operations Number of rows to generate and look up with each binding
+ */
+void benchmarkLookups(BugRepository& repository, int operations) {
+    repository.execute("BEGIN;");
+    for (int i = 0; i < operations; i++) {
+        repository.add({ "Bug " + to_string(i), "Lookup benchmark row", Priority::Low });
+    }
+    repository.execute("COMMIT;");
 
-    rc = sqlite3_step(stmt);
-    if (rc != SQLITE_DONE) {
-        cerr << "Failed to update bug: " << sqlite3_errmsg(db) << endl;
-    } else {
-        cout << "Bug updated.\n";
+    auto report = [operations](const char* name, chrono::steady_clock::time_point start, int found) {
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cerr << name << static_cast<long long>(seconds * 1e9 / operations) << " ns/lookup ("
+            << found << " found)\n";
+    };
+
+    auto start = chrono::steady_clock::now();
+    int found = 0;
+    for (int i = 1; i <= operations; i++) {
+        CachedStatement stmt = repository.statement(SQL_BUG_EXISTS);
+        string id = to_string(i);
+        sqlite3_bind_text(stmt, 1, id.c_str(), -1, SQLITE_TRANSIENT);
+        if (sqlite3_step(stmt) == SQLITE_ROW && sqlite3_column_int(stmt, 0) > 0) found++;
     }
+    report("text binding:  ", start, found);
 
-    sqlite3_finalize(stmt);
+    start = chrono::steady_clock::now();
+    found = 0;
+    for (int i = 1; i <= operations; i++) {
+        found += repository.exists(BugId{ i });
+    }
+    report("int64 binding: ", start, found);
 }
 
 /**
- * Deletes a bug from the database
- * Validates the bug ID and checks if the bug exists
- * Uses parameterized queries to prevent SQL injection
+ * Measures single-row autocommit insert and update throughput under every pragma profile
+ * Each profile runs against its own temporary database file, which is removed afterwards
+ * @param operations Number of inserts, and then updates, to run per profile
  */
-void deleteBug() {
-    string id = getValidInput("Bug ID to delete: ", 
-        "Invalid ID. Please enter a positive number.", 
-        isValidBugId);
+void benchmarkProfiles(int operations) {
+    for (const auto& entry : PRAGMA_PROFILES) {
+        string path = string("bench_") + entry.first + ".db";
+        remove(path.c_str());
+        BugRepository repository;
+        if (!repository.open(path, entry.second)) {
+            return;
+        }
 
-    if (!bugExists(id)) {
-        cout << "Error: Bug with ID " << id << " does not exist.\n";
-        return;
-    }
+        auto start = chrono::steady_clock::now();
+        for (int i = 0; i < operations; i++) {
+            repository.add({ "Bug " + to_string(i), "Profile benchmark row", Priority::Medium });
+        }
+        double insertSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
 
-    sqlite3_stmt* stmt;
-    const char* sql = "DELETE FROM bugs WHERE ID = ?;";
-    
-    int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr);
-    if (rc != SQLITE_OK) {
-        cerr << "Failed to prepare statement: " << sqlite3_errmsg(db) << endl;
-        return;
-    }
+        start = chrono::steady_clock::now();
+        for (int i = 1; i <= operations; i++) {
+            repository.updateStatus(BugId{ i }, Status::Resolved);
+        }
+        double updateSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
 
-    sqlite3_bind_text(stmt, 1, id.c_str(), -1, SQLITE_TRANSIENT);
+        cerr << entry.first << ": " << static_cast<long long>(operations / insertSeconds) << " inserts/sec, "
+            << static_cast<long long>(operations / updateSeconds) << " updates/sec\n";
 
-    rc = sqlite3_step(stmt);
-    if (rc != SQLITE_DONE) {
-        cerr << "Failed to delete bug: " << sqlite3_errmsg(db) << endl;
-    } else {
-        cout << "Bug deleted.\n";
+        repository.close();
+        for (const char* suffix : { "", "-wal", "-shm", "-journal" }) {
+            remove((path + suffix).c_str());
+        }
     }
-
-    sqlite3_finalize(stmt);
 }
 
 /**
  * Displays the main menu options
  */
 void menu() {
-    cout << "\n1. Add Bug\n2. List Bugs\n3. Update Bug\n4. Delete Bug\n5. Exit\nChoice: ";
+    cout << "\n1. Add Bug\n2. List Bugs\n3. Update Bug\n4. Delete Bug\n5. Search Bugs\n6. Statistics\n7. Exit\nChoice: ";
 }
 
+// Largest --bug-cache-mb accepted, 1 TiB
+const long long MAX_BUG_CACHE_MB = 1024 * 1024;
+
 /**
  * Main function that initializes the database and runs the main program loop
- * @return 0 on successful execution, 1 on database initialization failure
+ * @param argc Number of command line arguments
+ * @param argv A subcommand (add, get, list, search, update, delete, export; see Command) with its flags, or options:
+ *             --stdin-batch runs one subcommand per line of stdin in a single transaction and exits
+ *             --import <file> imports bugs from a CSV or NDJSON file and exits
+ *             --page-size <n> sets the number of bugs listed per page
+ *             --format=table|csv|ndjson selects the listing format
+ *             --profile=durable|balanced|fast|legacy selects the connection pragma preset
+ *             --journal-mode, --synchronous, --cache-size, --mmap-size, --temp-store override single pragmas
+ *             --check-plans verifies that no built-in query needs a full scan and exits
+ *             --bench-output <rows> benchmarks listing throughput on an in-memory database and exits
+ *             --bench-bugid <n> benchmarks bug ID validation over n inputs and exits
+ *             --bench-lookup <n> benchmarks ID lookups bound as text and as int64 and exits
+ *             --bench-profiles <ops> benchmarks insert/update throughput of every profile and exits
+ *             --search <terms> prints the best full-text matches and exits
+ *             --stats prints the number of bugs per status and priority and exits
+ *             --check-stats recounts the bugs and exits with an error if the summary table differs
+ *             --repair-stats rebuilds the summary table from the bugs table and exits
+ *             --time-to-resolve <days> prints resolutions and mean time to resolve over the last days (0 for all time) and exits
+ *             --aging prints the bugs not yet resolved grouped by age and exits
+ *             --bug-cache-mb <n> sets the memory cap of the bug cache in MiB, 0 to disable it
+ *             --cache-stats prints statement cache counters on exit
+ *             --serve runs the HTTP/JSON API until interrupted instead of the menu
+ *             --port <n>, --bind <address>, --workers <n>, --group-commit configure --serve
+ * @return 0 on successful execution, 1 on database initialization, import or server failure
  */
-int main() {
+int main(int argc, char* argv[]) {
+    bool showCacheStats = false;
+    bool checkPlans = false;
+    string importPath;
+    string searchTerms;
+    vector<string> commandWords;
+    bool stdinBatch = false;
+    bool formatGiven = false;
+    bool showStats = false;
+    bool checkStats = false;
+    bool repairStats = false;
+    int resolveDays = -1;
+    bool showAging = false;
+    long long bugCacheMb = DEFAULT_BUG_CACHE_BYTES / (1024 * 1024);
+    int benchRows = 0;
+    int benchProfileOps = 0;
+    long long benchBugIds = 0;
+    int benchLookups = 0;
+    string profileName = DEFAULT_PRAGMA_PROFILE;
+    string journalMode, synchronous, cacheSize, mmapSize, tempStore;
+    bool serve = false;
+    ServerOptions serverOptions;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        string value;
+        size_t eq = arg.find('=');
+        if (arg.compare(0, 2, "--") == 0 && eq != string::npos) {
+            value = arg.substr(eq + 1);
+            arg = arg.substr(0, eq);
+        }
+        auto takeValue = [&]() {
+            if (value.empty() && i + 1 < argc) value = argv[++i];
+            return !value.empty();
+        };
+        // Takes the value of a numeric option, which must be a count between lowest and highest
+        auto takeCount = [&](long long lowest, long long highest, auto& target) {
+            long long count;
+            if (!takeValue() || !parseCount(value, lowest, highest, count)) {
+                cerr << arg << " must be a number between " << lowest << " and " << highest << endl;
+                return false;
+            }
+            target = static_cast<remove_reference_t<decltype(target)>>(count);
+            return true;
+        };
+        const int maxInt = numeric_limits<int>::max();
+        bool valid = true;
+
+        if (arg == "--cache-stats") showCacheStats = true;
+        else if (arg == "--check-plans") checkPlans = true;
+        else if (arg == "--format" && takeValue()) {
+            OutputFormat format;
+            if (!parseOutputFormat(value, format)) {
+                cerr << "Unknown format: " << value << " (expected table, csv or ndjson)" << endl;
+                return 1;
+            }
+            output.setFormat(format);
+            formatGiven = true;
+        }
+        else if (arg == "--profile" && takeValue()) profileName = value;
+        else if (arg == "--journal-mode" && takeValue()) journalMode = value;
+        else if (arg == "--synchronous" && takeValue()) synchronous = value;
+        else if (arg == "--cache-size" && takeValue()) cacheSize = value;
+        else if (arg == "--mmap-size" && takeValue()) mmapSize = value;
+        else if (arg == "--temp-store" && takeValue()) tempStore = value;
+        else if (arg == "--bench-output") valid = takeCount(1, maxInt, benchRows);
+        else if (arg == "--bench-profiles") valid = takeCount(1, maxInt, benchProfileOps);
+        else if (arg == "--bench-bugid") valid = takeCount(1, numeric_limits<long long>::max(), benchBugIds);
+        else if (arg == "--bench-lookup") valid = takeCount(1, maxInt, benchLookups);
+        else if (arg == "--import" && takeValue()) importPath = value;
+        else if (arg == "--search" && takeValue()) searchTerms = value;
+        else if (arg == "--stdin-batch") stdinBatch = true;
+        else if (isCommandFlag(arg) && takeValue()) {
+            commandWords.push_back(arg);
+            commandWords.push_back(value);
+        }
+        else if (!arg.empty() && arg[0] != '-') commandWords.push_back(arg);
+        else if (arg == "--stats") showStats = true;
+        else if (arg == "--check-stats") checkStats = true;
+        else if (arg == "--repair-stats") repairStats = true;
+        else if (arg == "--time-to-resolve") valid = takeCount(0, MAX_RESOLVE_DAYS, resolveDays);
+        else if (arg == "--aging") showAging = true;
+        else if (arg == "--bug-cache-mb") valid = takeCount(0, MAX_BUG_CACHE_MB, bugCacheMb);
+        else if (arg == "--serve") serve = true;
+        else if (arg == "--port") valid = takeCount(1, 65535, serverOptions.port);
+        else if (arg == "--bind" && takeValue()) serverOptions.bindAddress = value;
+        else if (arg == "--workers") valid = takeCount(0, MAX_SERVER_WORKERS, serverOptions.workers);
+        else if (arg == "--group-commit") serverOptions.groupCommit = true;
+        else if (arg == "--page-size") valid = takeCount(1, MAX_LIST_PAGE_SIZE, listPageSize);
+        else {
+            cerr << "Unknown argument: " << argv[i] << endl;
+            return 1;
+        }
+        if (!valid) {
+            return 1;
+        }
+    }
+
+    // Resolve the pragma profile, then apply individual overrides on top of it
+    PragmaProfile profile;
+    if (!findPragmaProfile(profileName, profile)) {
+        cerr << "Unknown profile: " << profileName << " (expected durable, balanced, fast or legacy)" << endl;
+        return 1;
+    }
+    if (!journalMode.empty()) profile.journalMode = journalMode;
+    if (!synchronous.empty()) profile.synchronous = synchronous;
+    if (!tempStore.empty()) profile.tempStore = tempStore;
+    if (!cacheSize.empty()) profile.cacheSize = atoll(cacheSize.c_str());
+    if (!mmapSize.empty()) profile.mmapSize = atoll(mmapSize.c_str());
+    if (!isAllowedKeyword(profile.journalMode, { "DELETE", "TRUNCATE", "PERSIST", "MEMORY", "WAL", "OFF" }) ||
+        !isAllowedKeyword(profile.synchronous, { "OFF", "NORMAL", "FULL", "EXTRA" }) ||
+        !isAllowedKeyword(profile.tempStore, { "DEFAULT", "FILE", "MEMORY" })) {
+        cerr << "Invalid journal mode, synchronous level or temp store." << endl;
+        return 1;
+    }
+
+    // Benchmark modes
+    if (benchBugIds > 0) {
+        benchmarkBugIdParsing(benchBugIds);
+        return 0;
+    }
+    if (benchProfileOps > 0) {
+        benchmarkProfiles(benchProfileOps);
+        return 0;
+    }
+    // Declared before the repository, which must not outlive it
+    BugCache bugCache(static_cast<size_t>(bugCacheMb) * 1024 * 1024);
+    BugRepository repository;
+    if (benchRows > 0 || benchLookups > 0) {
+        if (!repository.open(":memory:", profile)) return 1;
+        if (benchRows > 0) benchmarkOutput(repository, benchRows);
+        else benchmarkLookups(repository, benchLookups);
+        return 0;
+    }
+
+    // HTTP/JSON server mode; every worker opens its own connection
+    if (serve) {
+        serverOptions.profile = profile;
+        serverOptions.bugCacheBytes = static_cast<size_t>(bugCacheMb) * 1024 * 1024;
+        serverOptions.printCacheStats = showCacheStats;
+        return runServer(serverOptions) ? 0 : 1;
+    }
+
     // Open database connection
-    int rc = sqlite3_open("bugs.db", &db);
-    if (rc) {
-        cerr << "Can't open database: " << sqlite3_errmsg(db) << endl;
+    if (!repository.open("bugs.db", profile)) {
         return 1;
     }
+    if (bugCacheMb > 0) {
+        repository.setCache(&bugCache);
+    }
+
+    if (checkPlans) {
+        bool ok = repository.checkQueryPlans();
+        cout << (ok ? "All built-in queries use index or rowid lookups.\n" : "Query plan check failed.\n");
+        return ok ? 0 : 1;
+    }
+
+    // Scriptable subcommands, writing ndjson (export: csv) unless --format says otherwise
+    if (!commandWords.empty() || stdinBatch) {
+        bool exporting = !commandWords.empty() && commandWords[0] == "export";
+        if (!formatGiven) {
+            output.setFormat(exporting ? OutputFormat::Csv : OutputFormat::Ndjson);
+        }
+        bool ok;
+        if (stdinBatch) {
+            if (!commandWords.empty()) {
+                cerr << "--stdin-batch reads its commands from stdin and takes none on the command line." << endl;
+                return 1;
+            }
+            ok = runBatch(repository, cin);
+        } else {
+            // Flags without a command name list bugs, as --since and --until did before subcommands existed
+            if (commandWords[0].compare(0, 2, "--") == 0) {
+                commandWords.insert(commandWords.begin(), "list");
+            }
+            Command command;
+            string error;
+            if (!parseCommand(commandWords, command, error)) {
+                cerr << error << endl;
+                return 1;
+            }
+            ok = exporting ? runExportCommand(repository, command, profile) : runCommand(repository, command);
+            output.flush();
+        }
+        if (showCacheStats) repository.printStatementCacheStats();
+        return ok ? 0 : 1;
+    }
+
+    if (showStats) {
+        return printStats(repository) ? 0 : 1;
+    }
+    if (resolveDays >= 0) {
+        return printTimeToResolve(repository, resolveDays) ? 0 : 1;
+    }
+    if (showAging) {
+        return printAging(repository) ? 0 : 1;
+    }
+    if (repairStats) {
+        bool ok = repository.rebuildCounts();
+        cout << (ok ? "Bug counts rebuilt.\n" : "Bug count rebuild failed.\n");
+        return ok ? 0 : 1;
+    }
+    if (checkStats) {
+        bool ok = repository.checkCounts();
+        cout << (ok ? "Bug counts match the bugs table.\n" : "Bug count check failed.\n");
+        return ok ? 0 : 1;
+    }
+
+    // Non-interactive full-text search mode
+    if (!searchTerms.empty()) {
+        bool ok = printSearchResults(repository, searchTerms);
+        if (showCacheStats) repository.printStatementCacheStats();
+        return ok ? 0 : 1;
+    }
+
+    // Non-interactive import mode
+    if (!importPath.empty()) {
+        bool ok = importBugs(repository, importPath);
+        if (showCacheStats) repository.printStatementCacheStats();
+        return ok ? 0 : 1;
+    }
 
-    // Create the bugs table if it doesn't exist
-    createTable();
     string choice;
 
     // Main program loop
     while (true) {
         menu();
         getline(cin, choice);
-        if (choice == "1") addBug();
-        else if (choice == "2") listBugs();
-        else if (choice == "3") updateBug();
-        else if (choice == "4") deleteBug();
-        else if (choice == "5") break;
+        if (choice == "1") addBug(repository);
+        else if (choice == "2") listBugs(repository);
+        else if (choice == "3") updateBug(repository);
+        else if (choice == "4") deleteBug(repository);
+        else if (choice == "5") searchBugs(repository);
+        else if (choice == "6") showStatistics(repository);
+        else if (choice == "7") break;
         else cout << "Invalid option.\n";
     }
 
-    // Clean up database connection
-    sqlite3_close(db);
+    if (showCacheStats) {
+        repository.printStatementCacheStats();
+        bugCache.printStats();
+    }
+
+    // Clean up cached statements and database connection
+    repository.close();
     return 0;
 }
-
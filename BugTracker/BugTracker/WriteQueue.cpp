@@ -0,0 +1,245 @@
+#include "WriteQueue.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+using namespace std;
+
+// How long the writer waits for another connection's write lock before failing a batch
+const int WRITER_BUSY_TIMEOUT_MS = 5000;
+
+/**
+ * Commits everything still queued and stops the writer
+ */
+WriteQueue::~WriteQueue() {
+    close();
+}
+
+/**
+ * Opens the writer's connection and starts the writer thread
+ * @param path Path of the database file
+ * @param profile Connection settings; synchronous decides how durable a completed future is
+ * @param maxBatchRows Largest number of bugs committed in one transaction
+ * @param maxDelay Longest the oldest bug of a batch waits for more bugs; 0 commits whatever is queued at once
+ * @return true if the queue accepts submissions, false otherwise
+ */
+bool WriteQueue::open(const string& path, const PragmaProfile& profile, size_t maxBatchRows,
+    chrono::microseconds maxDelay) {
+    close();
+    if (!repository.open(path, profile) ||
+        !repository.execute("PRAGMA busy_timeout = " + to_string(WRITER_BUSY_TIMEOUT_MS) + ";")) {
+        repository.close();
+        return false;
+    }
+    this->maxBatchRows = max<size_t>(1, maxBatchRows);
+    this->maxDelay = maxDelay;
+    closing = false;
+    writer = thread(&WriteQueue::writerLoop, this);
+    return true;
+}
+
+/**
+ * Commits every queued bug, stops the writer thread and closes its connection
+ */
+void WriteQueue::close() {
+    if (!writer.joinable()) {
+        return;
+    }
+    {
+        lock_guard<mutex> lock(queueMutex);
+        closing = true;
+    }
+    ready.notify_one();
+    writer.join();
+    repository.close();
+}
+
+/**
+ * Queues a bug for the next batch
+ * @param bug The bug to add; it is validated by the writer like BugRepository::add()
+ * @return A future holding the new bug's ID once its batch is committed, or nothing if the
+ *         bug was invalid, the commit failed or the queue is closed
+ */
+future<optional<BugId>> WriteQueue::submit(NewBug bug) {
+    PendingWrite write;
+    write.kind = WriteKind::Add;
+    write.bug = move(bug);
+    future<optional<BugId>> result = write.added.get_future();
+    if (!enqueue(write)) {
+        write.added.set_value(nullopt);
+    }
+    return result;
+}
+
+/**
+ * Queues a status change for the next batch
+ * @param id ID of the bug
+ * @param status The new status
+ * @return A future holding the outcome once its batch is committed; Failed if the commit failed or the queue is closed
+ */
+future<MutationResult> WriteQueue::submitStatus(BugId id, Status status) {
+    PendingWrite write;
+    write.kind = WriteKind::UpdateStatus;
+    write.id = id;
+    write.status = status;
+    future<MutationResult> result = write.changed.get_future();
+    if (!enqueue(write)) {
+        write.changed.set_value(MutationResult::Failed);
+    }
+    return result;
+}
+
+/**
+ * Queues a deletion for the next batch
+ * @param id ID of the bug
+ * @return A future holding the outcome once its batch is committed; Failed if the commit failed or the queue is closed
+ */
+future<MutationResult> WriteQueue::submitRemove(BugId id) {
+    PendingWrite write;
+    write.kind = WriteKind::Remove;
+    write.id = id;
+    future<MutationResult> result = write.changed.get_future();
+    if (!enqueue(write)) {
+        write.changed.set_value(MutationResult::Failed);
+    }
+    return result;
+}
+
+/**
+ * Moves a change onto the queue and wakes the writer when it has to look at the queue
+ * @param write The change; left untouched if the queue is closed
+ * @return true if the change was queued, false if the queue is closed
+ */
+bool WriteQueue::enqueue(PendingWrite& write) {
+    write.queued = chrono::steady_clock::now();
+    size_t queued;
+    {
+        lock_guard<mutex> lock(queueMutex);
+        if (closing || !writer.joinable()) {
+            return false;
+        }
+        queue.push_back(move(write));
+        queued = queue.size();
+    }
+    // The writer only waits for the first change of a batch or for the batch to fill up
+    if (queued == 1 || queued >= maxBatchRows) {
+        ready.notify_one();
+    }
+    return true;
+}
+
+/**
+ * Writer thread: takes a batch off the queue, commits it in one transaction and completes its futures
+ */
+void WriteQueue::writerLoop() {
+    vector<PendingWrite> batch;
+    batch.reserve(maxBatchRows);
+    while (true) {
+        {
+            unique_lock<mutex> lock(queueMutex);
+            ready.wait(lock, [this] { return closing || !queue.empty(); });
+            if (queue.empty()) {
+                return;
+            }
+
+            // Give later submitters until the oldest change's deadline to join this batch
+            if (maxDelay.count() > 0 && queue.size() < maxBatchRows && !closing) {
+                auto deadline = queue.front().queued + maxDelay;
+                ready.wait_until(lock, deadline, [this] { return closing || queue.size() >= maxBatchRows; });
+            }
+
+            size_t count = min(queue.size(), maxBatchRows);
+            for (size_t i = 0; i < count; i++) {
+                batch.push_back(move(queue.front()));
+                queue.pop_front();
+            }
+        }
+
+        commitBatch(batch);
+        batch.clear();
+    }
+}
+
+/**
+ * Applies one queued change inside the batch's transaction
+ * @param write The change
+ * @param id Receives the ID of an added bug
+ * @param result Receives the outcome of a status change or deletion
+ * @return true if the change was applied or found nothing to change, false if a statement failed
+ */
+bool WriteQueue::applyWrite(PendingWrite& write, optional<BugId>& id, MutationResult& result) {
+    switch (write.kind) {
+    case WriteKind::Add:
+        id = repository.add(write.bug);
+        return id.has_value();
+    case WriteKind::UpdateStatus:
+        result = repository.updateStatus(write.id, write.status);
+        return result != MutationResult::Failed;
+    case WriteKind::Remove:
+        result = repository.remove(write.id);
+        return result != MutationResult::Failed;
+    }
+    return false;
+}
+
+/**
+ * Applies a batch in one transaction and completes its futures
+ * The batch runs under a single savepoint, as every savepoint flushes the pending FTS5 terms. If a change
+ * fails, the batch is rolled back to it and replayed with a savepoint per change, so the failed change
+ * leaves nothing behind and the rest still commit. If the transaction cannot commit, every change fails.
+ * @param batch The changes to apply, in submission order
+ */
+void WriteQueue::commitBatch(vector<PendingWrite>& batch) {
+    vector<optional<BugId>> ids(batch.size());
+    vector<MutationResult> results(batch.size(), MutationResult::Failed);
+    auto replayBatch = [&]() {
+        for (size_t i = 0; i < batch.size(); i++) {
+            ids[i] = nullopt;
+            results[i] = MutationResult::Failed;
+            if (!repository.execute("SAVEPOINT change;")) {
+                return false;
+            }
+            bool applied = applyWrite(batch[i], ids[i], results[i]);
+            if ((!applied && !repository.execute("ROLLBACK TO change;")) || !repository.execute("RELEASE change;")) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    // IMMEDIATE takes the write lock up front, so the batch never fails halfway on a lock upgrade
+    bool ok = repository.execute("BEGIN IMMEDIATE;");
+    if (ok) {
+        ok = repository.execute("SAVEPOINT batch;");
+        bool applied = true;
+        for (size_t i = 0; i < batch.size() && ok && applied; i++) {
+            applied = applyWrite(batch[i], ids[i], results[i]);
+        }
+        if (ok && !applied) {
+            ok = repository.execute("ROLLBACK TO batch;") && replayBatch();
+        }
+        ok = ok && repository.execute("RELEASE batch;");
+        if (!ok || !repository.execute("COMMIT;")) {
+            repository.execute("ROLLBACK;");
+            ok = false;
+        }
+    }
+    if (!ok) {
+        cerr << "Group commit of " << batch.size() << " changes failed." << endl;
+    }
+
+    unsigned long long committed = 0;
+    for (size_t i = 0; i < batch.size(); i++) {
+        PendingWrite& write = batch[i];
+        if (write.kind == WriteKind::Add) {
+            if (ok && ids[i]) committed++;
+            write.added.set_value(ok ? ids[i] : nullopt);
+        } else {
+            if (ok && results[i] == MutationResult::Done) committed++;
+            write.changed.set_value(ok ? results[i] : MutationResult::Failed);
+        }
+    }
+    batches++;
+    rows += committed;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "BugRepository.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Largest number of bugs committed in one transaction by default
+inline constexpr size_t DEFAULT_MAX_BATCH_ROWS = 1000;
+
+// Default time the first bug of a batch may wait for more bugs before it is committed
+inline constexpr std::chrono::microseconds DEFAULT_MAX_BATCH_DELAY{ 2000 };
+
+/**
+ * Group-commit write path
+ * Any number of threads submit new bugs, status changes and deletions; a single writer thread with
+ * its own connection drains the queue into one transaction per batch, so one fsync covers every
+ * change in the batch. A batch is committed once it holds maxBatchRows changes or its oldest change
+ * has waited maxDelay, whichever comes first. While a batch commits, new submissions collect into
+ * the next one. As the only writer, the queue never waits on another connection's write lock as
+ * long as every change to the database goes through it.
+ */
+class WriteQueue {
+public:
+    WriteQueue() = default;
+    ~WriteQueue();
+    WriteQueue(const WriteQueue&) = delete;
+    WriteQueue& operator=(const WriteQueue&) = delete;
+
+    bool open(const std::string& path, const PragmaProfile& profile,
+        size_t maxBatchRows = DEFAULT_MAX_BATCH_ROWS,
+        std::chrono::microseconds maxDelay = DEFAULT_MAX_BATCH_DELAY);
+    void close();
+    // Set before open(); the writer keeps the cache in step with the changes it commits
+    void setCache(BugCache* cache) { repository.setCache(cache); }
+
+    std::future<std::optional<BugId>> submit(NewBug bug);
+    std::future<MutationResult> submitStatus(BugId id, Status status);
+    std::future<MutationResult> submitRemove(BugId id);
+
+    unsigned long long batchesCommitted() const { return batches; }
+    unsigned long long rowsCommitted() const { return rows; }
+
+private:
+    enum class WriteKind {
+        Add,
+        UpdateStatus,
+        Remove
+    };
+
+    /**
+     * A submitted change and the promise completed once its batch is committed
+     * Adds complete added; status changes and deletions complete changed.
+     */
+    struct PendingWrite {
+        WriteKind kind = WriteKind::Add;
+        NewBug bug{};
+        BugId id{ 0 };
+        Status status = Status::Open;
+        std::promise<std::optional<BugId>> added;
+        std::promise<MutationResult> changed;
+        std::chrono::steady_clock::time_point queued;
+    };
+
+    bool enqueue(PendingWrite& write);
+    void writerLoop();
+    bool applyWrite(PendingWrite& write, std::optional<BugId>& id, MutationResult& result);
+    void commitBatch(std::vector<PendingWrite>& batch);
+
+    BugRepository repository;   // Used only by the writer thread once it runs
+    size_t maxBatchRows = DEFAULT_MAX_BATCH_ROWS;
+    std::chrono::microseconds maxDelay = DEFAULT_MAX_BATCH_DELAY;
+
+    std::mutex queueMutex;
+    std::condition_variable ready;
+    std::deque<PendingWrite> queue;
+    bool closing = false;
+    std::thread writer;
+
+    std::atomic<unsigned long long> batches{ 0 };
+    std::atomic<unsigned long long> rows{ 0 };
+};
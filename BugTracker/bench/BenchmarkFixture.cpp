@@ -0,0 +1,62 @@
+#include "BenchmarkFixture.h"
+#include <algorithm>
+#include <cstdio>
+#include <utility>
+
+using namespace std;
+
+BenchmarkDatabase::BenchmarkDatabase(string path) : filePath(move(path)) {
+}
+
+BenchmarkDatabase::~BenchmarkDatabase() {
+    remove();
+}
+
+/**
+ * Opens a fresh database at the fixture's path, removing any database an earlier run left there
+ * @param profile Connection settings
+ * @return true if the database was created, false otherwise
+ */
+bool BenchmarkDatabase::open(const PragmaProfile& profile) {
+    remove();
+    return repo.open(filePath, profile);
+}
+
+/**
+ * Files generated bugs through BugRepository::add(), committing every FILL_BATCH_SIZE rows
+ * @param rows Number of bugs to file
+ * @param makeBug Returns the bug to file for each index from 0 to rows - 1
+ * @return true if every bug was filed and committed, false as soon as one add() fails
+ */
+bool BenchmarkDatabase::fill(long long rows, const function<NewBug(long long)>& makeBug) {
+    for (long long i = 0; i < rows; i += FILL_BATCH_SIZE) {
+        if (!repo.execute("BEGIN;")) {
+            return false;
+        }
+        long long end = min(rows, i + FILL_BATCH_SIZE);
+        for (long long j = i; j < end; j++) {
+            if (!repo.add(makeBug(j))) {
+                repo.execute("ROLLBACK;");
+                return false;
+            }
+        }
+        if (!repo.execute("COMMIT;")) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Closes the repository and deletes the database file with its -wal, -shm and -journal files
+ */
+void BenchmarkDatabase::remove() {
+    repo.close();
+    for (const char* suffix : { "", "-wal", "-shm", "-journal" }) {
+        std::remove((filePath + suffix).c_str());
+    }
+}
+
+void countRowVisitor(sqlite3_stmt*, void* context) {
+    ++*static_cast<long long*>(context);
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "BugRepository.h"
+#include <functional>
+#include <string>
+
+// Rows inserted per transaction while filling a benchmark database
+inline constexpr long long FILL_BATCH_SIZE = 100000;
+
+/**
+ * A temporary database file for one benchmark, with the repository that works on it
+ * Whatever an earlier run left at the path is removed before the database is opened, and the database
+ * with its -wal, -shm and -journal files is removed again by remove() and when the fixture is destroyed.
+ */
+class BenchmarkDatabase {
+public:
+    explicit BenchmarkDatabase(std::string path);
+    ~BenchmarkDatabase();
+    BenchmarkDatabase(const BenchmarkDatabase&) = delete;
+    BenchmarkDatabase& operator=(const BenchmarkDatabase&) = delete;
+
+    bool open(const PragmaProfile& profile);
+    bool fill(long long rows, const std::function<NewBug(long long)>& makeBug);
+    void remove();
+
+    BugRepository& repository() { return repo; }
+    const std::string& path() const { return filePath; }
+
+private:
+    std::string filePath;
+    BugRepository repo;
+};
+
+// Row visitor that only counts rows, so benchmarks measure the query and not the output
+void countRowVisitor(sqlite3_stmt* stmt, void* context);
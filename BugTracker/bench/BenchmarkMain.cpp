@@ -0,0 +1,115 @@
+#include "Benchmarks.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+
+using namespace std;
+
+/**
+ * Runs the CRUD benchmark suite, or one of the scenario benchmarks instead
+ * @param argc Number of command line arguments
+ * @param argv Command line arguments:
+ *             --sizes <n,n,...> table sizes to benchmark (default 1000,100000,10000000)
+ *             --ops <n> calls per operation and size (default 10000)
+ *             --profile <name> connection pragma preset (default durable)
+ *             --dir <path> directory for the temporary databases (default current directory)
+ *             --search <rows> benchmarks full-text search against a generated database instead
+ *             --writes <rows> benchmarks autocommit inserts against the group-commit queue instead
+ *             --cache <lookups> benchmarks bug lookups with and without the bug cache instead
+ *             --stats <rows> benchmarks the summary table's insert cost and read speed instead
+ *             --history <rows> benchmarks the history queries against a generated database instead
+ *             --filters <rows> benchmarks filtered listings against a generated database instead
+ *             --export <rows> benchmarks export throughput per thread count against a generated database instead
+ * @return 0 on success, 1 on invalid arguments or database failure
+ */
+int main(int argc, char* argv[]) {
+    vector<long long> sizes = { 1000, 100000, 10000000 };
+    int operations = 10000;
+    string profileName = DEFAULT_PRAGMA_PROFILE;
+    string directory = ".";
+    int searchRows = 0;
+    int writeRows = 0;
+    int cacheLookups = 0;
+    int statsRows = 0;
+    int historyRows = 0;
+    int filterRows = 0;
+    int exportRows = 0;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (i + 1 >= argc) {
+            cerr << "Missing value for " << arg << endl;
+            return 1;
+        }
+        string value = argv[++i];
+        if (arg == "--sizes") {
+            sizes.clear();
+            size_t pos = 0;
+            while (pos < value.size()) {
+                size_t comma = value.find(',', pos);
+                if (comma == string::npos) comma = value.size();
+                sizes.push_back(atoll(value.substr(pos, comma - pos).c_str()));
+                pos = comma + 1;
+            }
+        }
+        else if (arg == "--ops") operations = atoi(value.c_str());
+        else if (arg == "--profile") profileName = value;
+        else if (arg == "--dir") directory = value;
+        else if (arg == "--search") searchRows = atoi(value.c_str());
+        else if (arg == "--writes") writeRows = atoi(value.c_str());
+        else if (arg == "--cache") cacheLookups = atoi(value.c_str());
+        else if (arg == "--stats") statsRows = atoi(value.c_str());
+        else if (arg == "--history") historyRows = atoi(value.c_str());
+        else if (arg == "--filters") filterRows = atoi(value.c_str());
+        else if (arg == "--export") exportRows = atoi(value.c_str());
+        else {
+            cerr << "Unknown argument: " << arg << endl;
+            return 1;
+        }
+    }
+
+    PragmaProfile profile;
+    if (!findPragmaProfile(profileName, profile)) {
+        cerr << "Unknown profile: " << profileName << endl;
+        return 1;
+    }
+
+    // Scenario benchmarks
+    if (searchRows > 0) {
+        return benchmarkSearch(directory, searchRows, profile) ? 0 : 1;
+    }
+    if (writeRows > 0) {
+        return benchmarkWrites(directory, writeRows, profile) ? 0 : 1;
+    }
+    if (cacheLookups > 0) {
+        return benchmarkCache(directory, cacheLookups, profile) ? 0 : 1;
+    }
+    if (statsRows > 0) {
+        return benchmarkStats(directory, statsRows, profile) ? 0 : 1;
+    }
+    if (historyRows > 0) {
+        return benchmarkHistory(directory, historyRows, profile) ? 0 : 1;
+    }
+    if (filterRows > 0) {
+        return benchmarkFilters(directory, filterRows, profile) ? 0 : 1;
+    }
+    if (exportRows > 0) {
+        return benchmarkExport(directory, exportRows, profile) ? 0 : 1;
+    }
+
+    if (operations <= 0 || any_of(sizes.begin(), sizes.end(), [](long long rows) { return rows <= 0; })) {
+        cerr << "Sizes and --ops must be positive." << endl;
+        return 1;
+    }
+
+    cout << "profile " << profileName << ", " << operations << " calls per operation\n";
+    cout << "      rows  op          ops/sec    p50 (us)    p99 (us)\n";
+    for (long long rows : sizes) {
+        if (!benchmarkSize(directory, rows, operations, profile)) {
+            return 1;
+        }
+    }
+    return 0;
+}
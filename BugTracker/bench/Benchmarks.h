@@ -0,0 +1,30 @@
+#pragma once
+
+#include "BugRepository.h"
+#include <string>
+
+// Each benchmark creates its databases in the given directory, reports on stdout or stderr and removes them again
+
+// CRUD operations against a database of the given size (CrudBenchmark.cpp)
+bool benchmarkSize(const std::string& directory, long long rows, int operations, const PragmaProfile& profile);
+
+// Full-text search against a generated vocabulary (SearchBenchmark.cpp)
+bool benchmarkSearch(const std::string& directory, int rows, const PragmaProfile& profile);
+
+// Autocommit inserts against the group-commit WriteQueue (WriteBenchmark.cpp)
+bool benchmarkWrites(const std::string& directory, int rows, const PragmaProfile& profile);
+
+// Skewed single-bug lookups with and without a BugCache (CacheBenchmark.cpp)
+bool benchmarkCache(const std::string& directory, int lookups, const PragmaProfile& profile);
+
+// Insert cost and read speed of the bug_counts summary (StatsBenchmark.cpp)
+bool benchmarkStats(const std::string& directory, int rows, const PragmaProfile& profile);
+
+// Time-to-resolve, aging and filing-window queries over a generated history (HistoryBenchmark.cpp)
+bool benchmarkHistory(const std::string& directory, int rows, const PragmaProfile& profile);
+
+// Filtered listings by shape against the same query without its index (FilterBenchmark.cpp)
+bool benchmarkFilters(const std::string& directory, int rows, const PragmaProfile& profile);
+
+// Export throughput per thread count (ExportBenchmark.cpp)
+bool benchmarkExport(const std::string& directory, int rows, const PragmaProfile& profile);
@@ -0,0 +1,72 @@
+#include "Benchmarks.h"
+#include "BenchmarkFixture.h"
+#include "BugCache.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+
+using namespace std;
+
+/**
+ * Measures single-bug lookups with and without a BugCache on a skewed workload
+ * Fills a temporary database file with 100,000 bugs, then looks bugs up with 90% of the lookups going
+ * to the newest 1% and the rest spread over all bugs, like the recently filed bugs most reads ask for.
+ * Runs without a cache, with the default memory cap, and with a cap too small for the hot bugs.
+ * @param directory Directory for the temporary database
+ * @param lookups Number of lookups per run
+ * @param profile Connection settings for the temporary database
+ * @return true if the benchmark ran, false if the database could not be created
+ */
+bool benchmarkCache(const string& directory, int lookups, const PragmaProfile& profile) {
+    const int rows = 100000;
+    const int hotRows = rows / 100;
+
+    BenchmarkDatabase database(directory + "/bench_cache.db");
+    if (!database.open(profile)) {
+        return false;
+    }
+    BugRepository& repository = database.repository();
+    string description(200, 'x');
+    bool filled = database.fill(rows, [&description](long long i) {
+        return NewBug{ "Bug " + to_string(i), description, Priority::Medium };
+    });
+    if (!filled) {
+        return false;
+    }
+
+    mt19937 random(42);
+    uniform_int_distribution<int> percent(0, 99);
+    uniform_int_distribution<int> hot(rows - hotRows + 1, rows);
+    uniform_int_distribution<int> any(1, rows);
+    vector<BugId> ids(lookups);
+    for (BugId& id : ids) {
+        id.value = percent(random) < 90 ? hot(random) : any(random);
+    }
+
+    auto run = [&](const char* name, BugCache* cache) {
+        repository.setCache(cache);
+        long long found = 0;
+        auto start = chrono::steady_clock::now();
+        for (BugId id : ids) {
+            found += repository.get(id).has_value();
+        }
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cerr << name << static_cast<long long>(seconds * 1e9 / lookups) << " ns/lookup (" << found << " found)\n";
+        if (cache) {
+            cerr << "  ";
+            cache->printStats();
+        }
+    };
+
+    run("no cache:            ", nullptr);
+    BugCache cache;
+    run("cache, default cap:  ", &cache);
+    BugCache smallCache(256 * 1024);
+    run("cache, 256 KiB cap:  ", &smallCache);
+
+    // The caches go out of scope before the fixture closes the repository
+    repository.setCache(nullptr);
+    return true;
+}
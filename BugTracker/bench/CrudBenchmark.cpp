@@ -0,0 +1,139 @@
+#include "Benchmarks.h"
+#include "BenchmarkFixture.h"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <optional>
+#include <random>
+
+using namespace std;
+
+// Bugs listed per page by the list operation, matching the interactive default
+const int LIST_PAGE_SIZE = 20;
+
+/**
+ * Latency samples of one operation
+ */
+struct OperationStats {
+    string name;
+    vector<double> latencies;   // Microseconds per call
+    double totalSeconds = 0;
+};
+
+/**
+ * Runs an operation repeatedly, timing every call
+ * @param name Name shown in the report
+ * @param operations Number of calls
+ * @param operation Called with the iteration index
+ * @return The collected samples
+ */
+OperationStats measure(const string& name, int operations, const function<void(int)>& operation) {
+    OperationStats stats;
+    stats.name = name;
+    stats.latencies.reserve(operations);
+
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < operations; i++) {
+        auto before = chrono::steady_clock::now();
+        operation(i);
+        stats.latencies.push_back(chrono::duration<double, micro>(chrono::steady_clock::now() - before).count());
+    }
+    stats.totalSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return stats;
+}
+
+/**
+ * Returns the given percentile of a sorted sample set
+ */
+double percentile(const vector<double>& sorted, double fraction) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    size_t index = static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5);
+    return sorted[index];
+}
+
+/**
+ * Prints one report line: ops/sec, p50 and p99 latency
+ */
+void report(long long rows, OperationStats& stats) {
+    sort(stats.latencies.begin(), stats.latencies.end());
+    cout << setw(10) << rows << "  " << left << setw(8) << stats.name << right
+        << setw(12) << static_cast<long long>(stats.latencies.size() / stats.totalSeconds)
+        << setw(12) << fixed << setprecision(2) << percentile(stats.latencies, 0.50)
+        << setw(12) << percentile(stats.latencies, 0.99) << defaultfloat << "\n";
+}
+
+/**
+ * Row visitor for the list operation; reads a column so the row is actually decoded
+ */
+void touchRow(sqlite3_stmt* stmt, void* context) {
+    *static_cast<long long*>(context) += sqlite3_column_bytes(stmt, 1);
+}
+
+/**
+ * Benchmarks every CRUD operation against a fresh database of the given size
+ * @param directory Directory for the temporary database file
+ * @param rows Number of bugs in the database before measuring
+ * @param operations Calls per operation
+ * @param profile Connection settings
+ * @return true if the database could be created and filled, false otherwise
+ */
+bool benchmarkSize(const string& directory, long long rows, int operations, const PragmaProfile& profile) {
+    BenchmarkDatabase database(directory + "/bugtracker_bench_" + to_string(rows) + ".db");
+    if (!database.open(profile)) {
+        return false;
+    }
+    BugRepository& repository = database.repository();
+
+    const Priority priorities[] = { Priority::Low, Priority::Medium, Priority::High };
+    auto start = chrono::steady_clock::now();
+    bool filled = database.fill(rows, [&priorities](long long i) {
+        return NewBug{ "Benchmark bug " + to_string(i), "Generated by the CRUD benchmark", priorities[i % 3] };
+    });
+    if (!filled) {
+        return false;
+    }
+    cerr << "Filled " << rows << " rows in "
+        << chrono::duration<double>(chrono::steady_clock::now() - start).count() << " s\n";
+
+    mt19937_64 random(rows);
+    uniform_int_distribution<long long> anyId(1, rows);
+    long long checksum = 0;
+
+    vector<OperationStats> results;
+    results.push_back(measure("exists", operations, [&](int) {
+        checksum += repository.exists(BugId{ anyId(random) });
+    }));
+    results.push_back(measure("get", operations, [&](int) {
+        optional<Bug> bug = repository.get(BugId{ anyId(random) });
+        checksum += bug ? static_cast<long long>(bug->title.size()) : 0;
+    }));
+    results.push_back(measure("list", operations, [&](int) {
+        sqlite3_int64 lastId = 0;
+        checksum += repository.visitPage(anyId(random) - 1, LIST_PAGE_SIZE, lastId, touchRow, &checksum);
+    }));
+    results.push_back(measure("update", operations, [&](int i) {
+        repository.updateStatus(BugId{ anyId(random) }, i % 2 ? Status::Resolved : Status::InProgress);
+    }));
+    results.push_back(measure("add", operations, [&](int i) {
+        repository.add({ "Added bug " + to_string(i), "Inserted by the CRUD benchmark", Priority::Medium });
+    }));
+
+    // Delete distinct IDs spread over the original rows so no call hits a missing bug
+    long long stride = max(1LL, rows / operations);
+    int deletes = static_cast<int>(min<long long>(operations, rows));
+    results.push_back(measure("delete", deletes, [&](int i) {
+        repository.remove(BugId{ 1 + i * stride });
+    }));
+
+    for (auto& stats : results) {
+        report(rows, stats);
+    }
+    cerr << "(checksum " << checksum << ")\n";
+    return true;
+}
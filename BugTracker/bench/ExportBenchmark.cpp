@@ -0,0 +1,62 @@
+#include "Benchmarks.h"
+#include "BenchmarkFixture.h"
+#include "Export.h"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <filesystem>
+
+using namespace std;
+
+/**
+ * Measures how export throughput scales with threads against a generated database
+ * Files the bugs into a temporary database, then exports it with 1, 2, 4, ... threads up to at least
+ * four and at least the number of cores, as gzip-compressed csv when built with zlib. The files go to
+ * bench_export in the directory, which is removed afterwards.
+ * @param directory Directory for the temporary database and export files
+ * @param rows Number of bugs to generate
+ * @param profile Connection settings for the temporary database
+ * @return true if every export succeeded, false otherwise
+ */
+bool benchmarkExport(const string& directory, int rows, const PragmaProfile& profile) {
+    BenchmarkDatabase database(directory + "/bench_export.db");
+    if (!database.open(profile)) {
+        return false;
+    }
+    BugRepository& repository = database.repository();
+    bool filled = database.fill(rows, [](long long i) {
+        return NewBug{ "Bug " + to_string(i), "Export benchmark row with \"quotes\", commas and text " + to_string(i),
+            static_cast<Priority>(i % 3) };
+    });
+    if (!filled) {
+        return false;
+    }
+
+    string exportDirectory = (filesystem::path(directory) / "bench_export").string();
+    int maxThreads = static_cast<int>(max(4u, thread::hardware_concurrency()));
+    double baseline = 0;
+    bool ok = true;
+    for (int threads = 1; ok; threads = min(threads * 2, maxThreads)) {
+        error_code error;
+        filesystem::remove_all(exportDirectory, error);
+        filesystem::create_directories(exportDirectory, error);
+        auto start = chrono::steady_clock::now();
+        long long exported = 0;
+        ok = exportBugs(repository, exportDirectory, threads, OutputFormat::Csv, profile, exported) && exported == rows;
+        double rate = exported / chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        if (threads == 1) baseline = rate;
+        cerr << setw(3) << threads << " threads: " << static_cast<long long>(rate) << " bugs/sec ("
+            << fixed << setprecision(2) << rate / baseline << "x)\n" << defaultfloat;
+        if (threads == maxThreads) {
+            break;
+        }
+    }
+    cerr << thread::hardware_concurrency() << " cores\n";
+
+    error_code error;
+    filesystem::remove_all(exportDirectory, error);
+    return ok;
+}
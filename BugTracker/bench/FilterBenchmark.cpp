@@ -0,0 +1,108 @@
+#include "Benchmarks.h"
+#include "BenchmarkFixture.h"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <optional>
+
+using namespace std;
+
+/**
+ * Measures filtered listings against a generated database
+ * Files the bugs into a temporary database with every status and priority, then times several filter shapes
+ * and, as the baseline, the first filter with the indexes disabled. Each shape runs many times with different
+ * values, and the statement cache counters show that every shape is prepared once. The fill time includes
+ * the status changes.
+ * @param directory Directory for the temporary database
+ * @param rows Number of bugs to generate
+ * @param profile Connection settings for the temporary database
+ * @return true if the benchmark ran, false if the database could not be created
+ */
+bool benchmarkFilters(const string& directory, int rows, const PragmaProfile& profile) {
+    const int reads = 200;
+    BenchmarkDatabase database(directory + "/bench_filters.db");
+    if (!database.open(profile)) {
+        return false;
+    }
+    BugRepository& repository = database.repository();
+    auto start = chrono::steady_clock::now();
+    bool filled = database.fill(rows, [](long long i) {
+        return NewBug{ "Bug " + to_string(i), "Filter benchmark row", static_cast<Priority>(i % 3) };
+    });
+    if (!filled) {
+        return false;
+    }
+    repository.execute("BEGIN;");
+    for (int i = 1; i <= rows; i++) {
+        if (i % 4 == 0) repository.updateStatus(BugId{ i }, Status::Resolved);
+        else if (i % 4 == 1) repository.updateStatus(BugId{ i }, Status::InProgress);
+    }
+    repository.execute("COMMIT;");
+    double fillSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    optional<Bug> newest = repository.get(BugId{ max(1, rows - 999) });
+    sqlite3_int64 recent = newest ? newest->created : 0;
+    FilterCursor middle;
+    if (optional<Bug> bug = repository.get(BugId{ max(1, rows / 2) })) {
+        middle = FilterCursor{ bug->created, bug->id.value };
+    }
+    long long checksum = 0;
+    long long matched = 0;
+    auto measure = [&](const char* name, const function<void(int, BugFilter&)>& shape) {
+        auto begin = chrono::steady_clock::now();
+        for (int i = 0; i < reads; i++) {
+            BugFilter filter;
+            shape(i, filter);
+            matched += repository.visitFiltered(filter, countRowVisitor, &checksum);
+        }
+        cerr << name << fixed << setprecision(1)
+            << chrono::duration<double, micro>(chrono::steady_clock::now() - begin).count() / reads << " us\n";
+    };
+
+    cerr << "filled " << rows << " bugs in " << fixed << setprecision(2) << fillSeconds << " s\n";
+    measure("status + priority, first 20:          ", [](int i, BugFilter& filter) {
+        filter.status = static_cast<Status>(i % 3);
+        filter.priority = static_cast<Priority>(i / 3 % 3);
+        filter.limit = 20;
+    });
+    measure("status, filed since newest 1,000:     ", [&](int i, BugFilter& filter) {
+        filter.status = static_cast<Status>(i % 3);
+        filter.sinceMs = recent;
+    });
+    measure("priority + time window, first 20:     ", [&](int i, BugFilter& filter) {
+        filter.priority = static_cast<Priority>(i % 3);
+        filter.sinceMs = recent - 60000;
+        filter.untilMs = recent + 60000;
+        filter.limit = 20;
+    });
+    measure("status, 20 after the middle bug:      ", [&](int i, BugFilter& filter) {
+        filter.status = static_cast<Status>(i % 3);
+        filter.after = middle;
+        filter.limit = 20;
+    });
+    measure("status + title prefix, first 20:      ", [](int i, BugFilter& filter) {
+        filter.status = static_cast<Status>(i % 3);
+        filter.titlePrefix = "Bug 9";
+        filter.limit = 20;
+    });
+
+    // Baseline: the first shape without its index, scanning and sorting every bug
+    start = chrono::steady_clock::now();
+    const int scans = 5;
+    for (int i = 0; i < scans; i++) {
+        CachedStatement stmt = repository.statement(
+            "SELECT ID, Title, Description, Status, Priority, Created, Updated FROM bugs NOT INDEXED "
+            "WHERE Status = ? AND Priority = ? ORDER BY Created, ID LIMIT 20;");
+        sqlite3_bind_int(stmt, 1, i % 3);
+        sqlite3_bind_int(stmt, 2, i / 3 % 3);
+        while (sqlite3_step(stmt) == SQLITE_ROW) checksum++;
+    }
+    cerr << "status + priority without indexes:    "
+        << chrono::duration<double, micro>(chrono::steady_clock::now() - start).count() / scans << " us\n"
+        << "(" << matched << " rows, checksum " << checksum << ")\n";
+    repository.printStatementCacheStats();
+    return true;
+}
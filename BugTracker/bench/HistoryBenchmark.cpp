@@ -0,0 +1,76 @@
+#include "Benchmarks.h"
+#include "BenchmarkFixture.h"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <algorithm>
+#include <chrono>
+#include <optional>
+
+using namespace std;
+
+/**
+ * Measures the time-to-resolve, aging and filing-window queries against a generated history
+ * Files the bugs into a temporary database, resolves every other one and moves a quarter of the rest to
+ * In Progress, so the history has about two events per bug. Also reports the insert rate with the history
+ * being recorded, for comparison with --stats. The window listing reads the newest 1,000 bugs.
+ * @param directory Directory for the temporary database
+ * @param rows Number of bugs to generate
+ * @param profile Connection settings for the temporary database
+ * @return true if the benchmark ran, false if the database could not be created
+ */
+bool benchmarkHistory(const string& directory, int rows, const PragmaProfile& profile) {
+    const int reads = 20;
+    BenchmarkDatabase database(directory + "/bench_history.db");
+    if (!database.open(profile)) {
+        return false;
+    }
+    BugRepository& repository = database.repository();
+    auto start = chrono::steady_clock::now();
+    bool filled = database.fill(rows, [](long long i) {
+        return NewBug{ "Bug " + to_string(i), "History benchmark row", static_cast<Priority>(i % 3) };
+    });
+    if (!filled) {
+        return false;
+    }
+    double insertSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    repository.execute("BEGIN;");
+    for (int i = 1; i <= rows; i++) {
+        if (i % 2 == 0) repository.updateStatus(BugId{ i }, Status::Resolved);
+        else if (i % 8 == 1) repository.updateStatus(BugId{ i }, Status::InProgress);
+    }
+    repository.execute("COMMIT;");
+    double updateSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    auto time = [&](auto query) {
+        auto begin = chrono::steady_clock::now();
+        for (int i = 0; i < reads; i++) {
+            query();
+        }
+        return chrono::duration<double, milli>(chrono::steady_clock::now() - begin).count() / reads;
+    };
+    long long now = currentTimeMs();
+    ResolveStats all;
+    ResolveStats none;
+    BugAging aging;
+    double allMs = time([&]() { repository.timeToResolve(0, now + 1, all); });
+    double noneMs = time([&]() { repository.timeToResolve(0, 1, none); });
+    double agingMs = time([&]() { repository.openBugAging(now, aging); });
+    optional<Bug> windowStart = repository.get(BugId{ max(1, rows - 999) });
+    BugFilter window;
+    window.sinceMs = windowStart ? windowStart->created : 0;
+    long long visited = 0;
+    long long windowRows = 0;
+    double windowMs = time([&]() { windowRows = repository.visitFiltered(window, countRowVisitor, &visited); });
+
+    cerr << "inserts with history: " << static_cast<long long>(rows / insertSeconds) << " rows/sec, "
+        << "status changes: " << static_cast<long long>(rows * 5 / 8 / updateSeconds) << " rows/sec\n"
+        << fixed << setprecision(2)
+        << "time to resolve, all " << all.resolved << " resolutions: " << allMs << " ms\n"
+        << "time to resolve, window without resolutions (" << none.resolved << "): " << noneMs << " ms\n"
+        << "aging of " << rows / 2 << " unresolved bugs: " << agingMs << " ms\n"
+        << "bugs filed since a time, " << windowRows << " rows: " << windowMs << " ms\n";
+    return true;
+}
@@ -0,0 +1,331 @@
+#include "Socket.h"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <random>
+#include <thread>
+
+using namespace std;
+
+// Bugs listed per page by the list request, matching the interactive default
+const int LIST_PAGE_SIZE = 20;
+
+/**
+ * Request mixes selectable with --mix
+ *   read  - 80% GET /bugs/<id>, 20% GET /bugs?after=&limit=
+ *   write - 40% POST, 40% PATCH, 20% DELETE of a bug the client added itself
+ *   mixed - 60% get, 15% list, 10% POST, 10% PATCH, 5% DELETE
+ */
+enum class Mix {
+    Read,
+    Write,
+    Mixed
+};
+
+/**
+ * A keep-alive client connection speaking just enough HTTP/1.1 for the bug API
+ */
+class HttpClient {
+public:
+    ~HttpClient() {
+        if (socket != INVALID_SOCKET_HANDLE) closeSocket(socket);
+    }
+
+    /**
+     * Connects to the server
+     * @return true on success, false otherwise
+     */
+    bool connect(const string& host, int port) {
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(static_cast<unsigned short>(port));
+        if (inet_pton(AF_INET, host.c_str(), &address.sin_addr) != 1) {
+            return false;
+        }
+        socket = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (socket == INVALID_SOCKET_HANDLE ||
+            ::connect(socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            return false;
+        }
+        setNoDelay(socket);
+        return true;
+    }
+
+    /**
+     * Sends one request and reads the whole response
+     * @param method HTTP method
+     * @param target Path and query
+     * @param body JSON body, empty for none
+     * @return The HTTP status code, or 0 if the connection failed
+     */
+    int request(const char* method, const string& target, const string& body) {
+        out.clear();
+        out.append(method);
+        out.push_back(' ');
+        out.append(target);
+        out.append(" HTTP/1.1\r\nHost: localhost\r\n");
+        if (!body.empty()) {
+            out.append("Content-Type: application/json\r\nContent-Length: ");
+            out.append(to_string(body.size()));
+            out.append("\r\n");
+        }
+        out.append("\r\n");
+        out.append(body);
+
+        size_t sent = 0;
+        while (sent < out.size()) {
+            long long n = send(socket, out.data() + sent, static_cast<int>(out.size() - sent), SEND_FLAGS);
+            if (n <= 0) return 0;
+            sent += static_cast<size_t>(n);
+        }
+
+        // Every response of the server carries Content-Length
+        size_t headEnd;
+        while ((headEnd = in.find("\r\n\r\n")) == string::npos) {
+            if (!receive()) return 0;
+        }
+        int status = atoi(in.c_str() + in.find(' ') + 1);
+        size_t lengthAt = in.find("Content-Length: ");
+        size_t length = lengthAt < headEnd ? strtoull(in.c_str() + lengthAt + 16, nullptr, 10) : 0;
+        while (in.size() < headEnd + 4 + length) {
+            if (!receive()) return 0;
+        }
+        responseBody.assign(in, headEnd + 4, length);
+        in.erase(0, headEnd + 4 + length);
+        return status;
+    }
+
+    // Body of the last response
+    string responseBody;
+
+private:
+    bool receive() {
+        char buffer[16384];
+        long long n = recv(socket, buffer, static_cast<int>(sizeof(buffer)), 0);
+        if (n <= 0) return false;
+        in.append(buffer, static_cast<size_t>(n));
+        return true;
+    }
+
+    socket_t socket = INVALID_SOCKET_HANDLE;
+    string out;
+    string in;
+};
+
+/**
+ * Reads the "id" of a response to POST /bugs
+ */
+long long responseId(const string& body) {
+    size_t at = body.find("\"id\":");
+    return at == string::npos ? 0 : atoll(body.c_str() + at + 5);
+}
+
+/**
+ * Results of one client thread
+ */
+struct ClientStats {
+    vector<double> latencies;   // Microseconds per request
+    long long errors = 0;       // Responses outside 2xx, and failed connections
+};
+
+/**
+ * Sends requests on one keep-alive connection, timing every round trip
+ * @param host Server address
+ * @param port Server port
+ * @param requests Number of requests to send
+ * @param mix Request mix
+ * @param minId First ID used for get, list and update
+ * @param maxId Last ID used for get, list and update
+ * @param seed Random seed of this client
+ * @param stats Receives the latencies and error count
+ */
+void runClient(const string& host, int port, int requests, Mix mix, long long minId, long long maxId, unsigned seed,
+    ClientStats& stats) {
+    HttpClient client;
+    if (!client.connect(host, port)) {
+        stats.errors = requests;
+        return;
+    }
+    stats.latencies.reserve(requests);
+
+    mt19937_64 random(seed);
+    uniform_int_distribution<long long> anyId(minId, maxId);
+    uniform_int_distribution<int> percent(0, 99);
+    vector<long long> added;
+    const char* statuses[] = { "Open", "In Progress", "Resolved" };
+
+    // Cumulative percentages of list, get, add and update requests; the rest are deletes
+    int listShare = mix == Mix::Read ? 20 : mix == Mix::Write ? 0 : 15;
+    int readShare = mix == Mix::Read ? 100 : mix == Mix::Write ? 0 : 75;
+    int addShare = readShare + (mix == Mix::Write ? 40 : mix == Mix::Mixed ? 10 : 0);
+    int updateShare = addShare + (mix == Mix::Write ? 40 : mix == Mix::Mixed ? 10 : 0);
+
+    for (int i = 0; i < requests; i++) {
+        int roll = percent(random);
+        const char* method = "GET";
+        bool adding = false;
+        string target;
+        string body;
+
+        if (roll < listShare) {
+            target = "/bugs?after=" + to_string(anyId(random) - 1) + "&limit=" + to_string(LIST_PAGE_SIZE);
+        } else if (roll < readShare) {
+            target = "/bugs/" + to_string(anyId(random));
+        } else if (roll < addShare || (roll >= updateShare && added.empty())) {
+            method = "POST";
+            adding = true;
+            target = "/bugs";
+            body = "{\"title\":\"Load test bug " + to_string(i) +
+                "\",\"description\":\"Filed by the HTTP load test\",\"priority\":\"Medium\"}";
+        } else if (roll < updateShare) {
+            method = "PATCH";
+            target = "/bugs/" + to_string(anyId(random));
+            body = string("{\"status\":\"") + statuses[i % 3] + "\"}";
+        } else {
+            method = "DELETE";
+            target = "/bugs/" + to_string(added.back());
+            added.pop_back();
+        }
+
+        auto before = chrono::steady_clock::now();
+        int status = client.request(method, target, body);
+        stats.latencies.push_back(chrono::duration<double, micro>(chrono::steady_clock::now() - before).count());
+        if (status == 0) {
+            stats.errors += requests - i;
+            return;
+        }
+        if (status < 200 || status > 299) {
+            stats.errors++;
+        } else if (adding) {
+            added.push_back(responseId(client.responseBody));
+        }
+    }
+}
+
+/**
+ * Returns the given percentile of a sorted sample set
+ */
+double percentile(const vector<double>& sorted, double fraction) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    size_t index = static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5);
+    return sorted[index];
+}
+
+/**
+ * Drives a running BugTracker --serve instance from several keep-alive connections
+ * and reports throughput and latency percentiles
+ * @param argc Number of command line arguments
+ * @param argv Command line arguments:
+ *             --host <address> server address (default 127.0.0.1)
+ *             --port <n> server port (default 8080)
+ *             --connections <n> concurrent client connections, one thread each (default 8)
+ *             --requests <n> total requests over all connections (default 20000)
+ *             --mix read|write|mixed request mix (default mixed)
+ *             --seed <n> bugs added before measuring, the ID range used by reads and updates (default 1000)
+ * @return 0 if every request succeeded, 1 on invalid arguments, connection failure or error responses
+ */
+int main(int argc, char* argv[]) {
+    string host = "127.0.0.1";
+    int port = 8080;
+    int connections = 8;
+    int requests = 20000;
+    string mixName = "mixed";
+    int seedBugs = 1000;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (i + 1 >= argc) {
+            cerr << "Missing value for " << arg << endl;
+            return 1;
+        }
+        string value = argv[++i];
+        if (arg == "--host") host = value;
+        else if (arg == "--port") port = atoi(value.c_str());
+        else if (arg == "--connections") connections = atoi(value.c_str());
+        else if (arg == "--requests") requests = atoi(value.c_str());
+        else if (arg == "--mix") mixName = value;
+        else if (arg == "--seed") seedBugs = atoi(value.c_str());
+        else {
+            cerr << "Unknown argument: " << arg << endl;
+            return 1;
+        }
+    }
+
+    Mix mix;
+    if (mixName == "read") mix = Mix::Read;
+    else if (mixName == "write") mix = Mix::Write;
+    else if (mixName == "mixed") mix = Mix::Mixed;
+    else {
+        cerr << "Unknown mix: " << mixName << " (expected read, write or mixed)" << endl;
+        return 1;
+    }
+    if (connections <= 0 || requests <= 0 || seedBugs <= 0) {
+        cerr << "--connections, --requests and --seed must be positive." << endl;
+        return 1;
+    }
+    if (!initSockets()) {
+        cerr << "Can't initialize sockets." << endl;
+        return 1;
+    }
+
+    // Seed the bugs the reads and updates pick from; earlier runs may have deleted older IDs
+    long long minId = 0;
+    long long maxId = 0;
+    {
+        HttpClient client;
+        if (!client.connect(host, port)) {
+            cerr << "Can't connect to " << host << ":" << port << "; start BugTracker --serve first." << endl;
+            return 1;
+        }
+        for (int i = 0; i < seedBugs; i++) {
+            int status = client.request("POST", "/bugs",
+                "{\"title\":\"Seed bug " + to_string(i) +
+                "\",\"description\":\"Filed before the HTTP load test\",\"priority\":\"Low\"}");
+            if (status != 201) {
+                cerr << "Seeding failed with status " << status << endl;
+                return 1;
+            }
+            long long id = responseId(client.responseBody);
+            if (i == 0) minId = id;
+            maxId = max(maxId, id);
+        }
+    }
+
+    vector<ClientStats> stats(connections);
+    vector<thread> clients;
+    auto start = chrono::steady_clock::now();
+    for (int c = 0; c < connections; c++) {
+        int share = requests / connections + (c < requests % connections ? 1 : 0);
+        clients.emplace_back(runClient, cref(host), port, share, mix, minId, maxId, 1000u + c, ref(stats[c]));
+    }
+    for (thread& t : clients) {
+        t.join();
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    vector<double> latencies;
+    long long errors = 0;
+    for (const auto& client : stats) {
+        latencies.insert(latencies.end(), client.latencies.begin(), client.latencies.end());
+        errors += client.errors;
+    }
+    sort(latencies.begin(), latencies.end());
+
+    cout << fixed << setprecision(2);
+    cout << "mix " << mixName << ", " << connections << " connections, " << latencies.size() << " requests, "
+        << errors << " errors\n";
+    cout << "requests/sec " << setprecision(0) << latencies.size() / seconds << setprecision(2) << "\n";
+    cout << "latency (us) p50 " << percentile(latencies, 0.50)
+        << "  p90 " << percentile(latencies, 0.90)
+        << "  p99 " << percentile(latencies, 0.99)
+        << "  p99.9 " << percentile(latencies, 0.999)
+        << "  max " << (latencies.empty() ? 0 : latencies.back()) << "\n";
+    return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,97 @@
+#include "Benchmarks.h"
+#include "BenchmarkFixture.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <random>
+
+using namespace std;
+
+// Results per query, matching the interactive search
+const int SEARCH_RESULT_LIMIT = 20;
+
+/**
+ * Measures full-text search latency against a generated database of the given size
+ * Titles and descriptions are drawn from a small vocabulary of common words, plus a tag that
+ * appears in only a few bugs, so the queries cover frequent, rare, multi-word and prefix terms.
+ * A LIKE '%tag%' scan of the same rare tag is timed as the baseline.
+ * @param directory Directory for the temporary database
+ * @param rows Number of bugs to generate
+ * @param profile Connection settings for the temporary database
+ * @return true if the benchmark ran, false if the database could not be created
+ */
+bool benchmarkSearch(const string& directory, int rows, const PragmaProfile& profile) {
+    static const char* const words[] = {
+        "crash", "login", "timeout", "button", "page", "error", "save", "report", "export", "window",
+        "freeze", "slow", "network", "password", "email", "upload", "image", "layout", "scroll", "font",
+        "memory", "leak", "database", "search", "filter", "sort", "cache", "session", "token", "menu",
+    };
+    const int wordCount = sizeof(words) / sizeof(words[0]);
+    const int tagCount = rows / 10 + 1;     // Each tag appears in about ten bugs
+
+    BenchmarkDatabase database(directory + "/bench_search.db");
+    if (!database.open(profile)) {
+        return false;
+    }
+    BugRepository& repository = database.repository();
+
+    mt19937 random(42);
+    uniform_int_distribution<int> anyWord(0, wordCount - 1);
+    uniform_int_distribution<int> anyTag(0, tagCount - 1);
+    auto phrase = [&](int length) {
+        string text;
+        for (int i = 0; i < length; i++) {
+            if (i) text.push_back(' ');
+            text.append(words[anyWord(random)]);
+        }
+        return text;
+    };
+
+    auto start = chrono::steady_clock::now();
+    bool filled = database.fill(rows, [&](long long i) {
+        string description = phrase(12) + " tag" + to_string(anyTag(random));
+        return NewBug{ phrase(4), description, static_cast<Priority>(i % 3) };
+    });
+    if (!filled) {
+        return false;
+    }
+    cerr << "Filled " << rows << " bugs with the full-text index in "
+        << chrono::duration<double>(chrono::steady_clock::now() - start).count() << " s\n";
+
+    const int queries = 200;
+    long long checksum = 0;
+    auto measure = [&](const char* name, const function<string(int)>& terms) {
+        vector<double> latencies;
+        for (int i = 0; i < queries; i++) {
+            string query = terms(i);
+            auto before = chrono::steady_clock::now();
+            repository.search(query, SEARCH_RESULT_LIMIT, countRowVisitor, &checksum);
+            latencies.push_back(chrono::duration<double, micro>(chrono::steady_clock::now() - before).count());
+        }
+        sort(latencies.begin(), latencies.end());
+        cerr << name << static_cast<long long>(latencies[queries / 2]) << " us p50, "
+            << static_cast<long long>(latencies[queries * 99 / 100]) << " us p99\n";
+    };
+    measure("frequent word:    ", [&](int i) { return string(words[i % wordCount]); });
+    measure("rare tag:         ", [&](int) { return "tag" + to_string(anyTag(random)); });
+    measure("two words:        ", [&](int i) { return string(words[i % wordCount]) + " " + words[(i * 7 + 3) % wordCount]; });
+    measure("prefix:           ", [&](int) { return "tag" + to_string(anyTag(random) % 100) + "*"; });
+
+    // Baseline: what a substring search costs without the index
+    const int scans = 5;
+    start = chrono::steady_clock::now();
+    for (int i = 0; i < scans; i++) {
+        CachedStatement stmt = repository.statement(
+            "SELECT ID FROM bugs WHERE Title LIKE ?1 OR Description LIKE ?1 LIMIT 20;");
+        string pattern = "% tag" + to_string(anyTag(random));
+        sqlite3_bind_text(stmt, 1, pattern.c_str(), -1, SQLITE_TRANSIENT);
+        while (sqlite3_step(stmt) == SQLITE_ROW) checksum++;
+    }
+    cerr << "LIKE scan (rare): " << static_cast<long long>(
+        chrono::duration<double, micro>(chrono::steady_clock::now() - start).count() / scans) << " us\n";
+    cerr << "(checksum " << checksum << ")\n";
+    return true;
+}
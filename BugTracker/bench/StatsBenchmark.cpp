@@ -0,0 +1,65 @@
+#include "Benchmarks.h"
+#include "BenchmarkFixture.h"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <chrono>
+
+using namespace std;
+
+/**
+ * Measures what maintaining bug_counts costs on inserts and what the summary saves on reads
+ * Inserts the rows into a temporary database file and times reading the counts from the summary against a
+ * GROUP BY. Then does the same inserts into a fresh database that also has an insert trigger doing the
+ * counting, the way the summary was first built, to show what a trigger would add.
+ * @param directory Directory for the temporary database
+ * @param rows Number of bugs inserted by each pass
+ * @param profile Connection settings for the temporary databases
+ * @return true if the benchmark ran and the summary matched, false otherwise
+ */
+bool benchmarkStats(const string& directory, int rows, const PragmaProfile& profile) {
+    const int reads = 100;
+    BenchmarkDatabase database(directory + "/bench_stats.db");
+    BugRepository& repository = database.repository();
+    auto insertRows = [&database, rows]() {
+        auto start = chrono::steady_clock::now();
+        bool filled = database.fill(rows, [](long long i) {
+            return NewBug{ "Bug " + to_string(i), "Stats benchmark row", static_cast<Priority>(i % 3) };
+        });
+        if (!filled) {
+            return -1LL;
+        }
+        return static_cast<long long>(rows / chrono::duration<double>(chrono::steady_clock::now() - start).count());
+    };
+
+    if (!database.open(profile)) {
+        return false;
+    }
+    long long counted = insertRows();
+
+    auto readTime = [&](bool (BugRepository::*read)(BugCounts&)) {
+        BugCounts counts;
+        auto start = chrono::steady_clock::now();
+        for (int i = 0; i < reads; i++) {
+            (repository.*read)(counts);
+        }
+        return chrono::duration<double, micro>(chrono::steady_clock::now() - start).count() / reads;
+    };
+    double summaryUs = readTime(&BugRepository::counts);
+    double groupByUs = readTime(&BugRepository::recount);
+    bool consistent = repository.checkCounts();
+
+    if (!database.open(profile) ||
+        !repository.execute("CREATE TRIGGER bench_count_insert AFTER INSERT ON bugs BEGIN "
+            "UPDATE bug_counts SET Count = Count + 1 WHERE Status = new.Status AND Priority = new.Priority; END;")) {
+        return false;
+    }
+    long long withTrigger = insertRows();
+
+    cerr << "inserts counted by add():           " << counted << " rows/sec\n"
+        << "inserts with an extra count trigger: " << withTrigger << " rows/sec\n"
+        << "counts from summary:  " << fixed << setprecision(1) << summaryUs << " us\n"
+        << "counts from GROUP BY: " << groupByUs << " us (" << rows << " bugs)\n"
+        << "summary " << (consistent ? "matches" : "does not match") << " the bugs table\n";
+    return consistent && counted >= 0 && withTrigger >= 0;
+}
@@ -0,0 +1,88 @@
+#include "Benchmarks.h"
+#include "BenchmarkFixture.h"
+#include "WriteQueue.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <optional>
+#include <thread>
+
+using namespace std;
+
+/**
+ * Compares single-row autocommit inserts with the group-commit WriteQueue
+ * Runs against a temporary database file with the chosen profile, so the cost of each commit's sync is included:
+ * autocommit from one thread, the queue with many submitters each waiting for its bug to commit,
+ * and the queue with one submitter that keeps every future in flight
+ * @param directory Directory for the temporary database
+ * @param rows Number of bugs inserted by each method
+ * @param profile Connection settings
+ * @return true if the benchmark ran, false if the database could not be opened
+ */
+bool benchmarkWrites(const string& directory, int rows, const PragmaProfile& profile) {
+    const int submitters = 64;
+    auto rate = [rows](chrono::steady_clock::time_point start) {
+        return static_cast<long long>(rows / chrono::duration<double>(chrono::steady_clock::now() - start).count());
+    };
+
+    BenchmarkDatabase database(directory + "/bench_writes.db");
+    if (!database.open(profile)) {
+        return false;
+    }
+    BugRepository& repository = database.repository();
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < rows; i++) {
+        repository.add({ "Bug " + to_string(i), "Write benchmark row", Priority::Medium });
+    }
+    cerr << "autocommit:             " << rate(start) << " inserts/sec\n";
+    repository.close();
+
+    WriteQueue writes;
+    if (!writes.open(database.path(), profile)) {
+        return false;
+    }
+    vector<vector<double>> latencies(submitters);
+    vector<thread> threads;
+    start = chrono::steady_clock::now();
+    for (int t = 0; t < submitters; t++) {
+        threads.emplace_back([&, t]() {
+            for (int i = t; i < rows; i += submitters) {
+                auto before = chrono::steady_clock::now();
+                writes.submit({ "Bug " + to_string(i), "Write benchmark row", Priority::Medium }).get();
+                latencies[t].push_back(chrono::duration<double, micro>(chrono::steady_clock::now() - before).count());
+            }
+        });
+    }
+    for (thread& t : threads) {
+        t.join();
+    }
+    long long closedLoopRate = rate(start);
+    vector<double> all;
+    for (const auto& samples : latencies) {
+        all.insert(all.end(), samples.begin(), samples.end());
+    }
+    sort(all.begin(), all.end());
+    unsigned long long batches = writes.batchesCommitted();
+    cerr << "group commit, " << submitters << " waiting submitters: " << closedLoopRate << " inserts/sec, "
+        << static_cast<long long>(all[all.size() / 2]) << " us p50, "
+        << static_cast<long long>(all[all.size() * 99 / 100]) << " us p99 until committed, "
+        << writes.rowsCommitted() / max(1ULL, batches) << " bugs per batch\n";
+
+    vector<future<optional<BugId>>> inFlight;
+    inFlight.reserve(rows);
+    start = chrono::steady_clock::now();
+    for (int i = 0; i < rows; i++) {
+        inFlight.push_back(writes.submit({ "Bug " + to_string(i), "Write benchmark row", Priority::Medium }));
+    }
+    for (auto& result : inFlight) {
+        result.wait();
+    }
+    cerr << "group commit, pipelined: " << rate(start) << " inserts/sec, "
+        << (writes.rowsCommitted() - rows) / max(1ULL, writes.batchesCommitted() - batches) << " bugs per batch\n";
+
+    writes.close();
+    return true;
+}
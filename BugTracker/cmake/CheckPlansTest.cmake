@@ -0,0 +1,15 @@
+# Creates a fresh database and checks that no built-in query plan needs a full scan or a sort.
+# Usage: cmake -DBUGTRACKER=<path to BugTracker> -DWORK_DIR=<scratch dir> -P CheckPlansTest.cmake
+
+file(REMOVE_RECURSE "${WORK_DIR}")
+file(MAKE_DIRECTORY "${WORK_DIR}")
+
+execute_process(
+    COMMAND "${BUGTRACKER}" --check-plans
+    WORKING_DIRECTORY "${WORK_DIR}"
+    OUTPUT_VARIABLE output
+    ERROR_VARIABLE errors
+    RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "--check-plans exited with ${result}:\n${output}${errors}")
+endif()
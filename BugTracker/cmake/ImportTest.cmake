@@ -0,0 +1,35 @@
+# Imports one file into a fresh database and checks how many records were imported and skipped.
+# Usage: cmake -DBUGTRACKER=<path to BugTracker> -DINPUT=<file to import> -DWORK_DIR=<scratch dir>
+#              -DEXPECTED="Imported <n> bugs (<m> skipped)" -DEXPECTED_TITLES="<title>;<title>;..." -P ImportTest.cmake
+
+file(REMOVE_RECURSE "${WORK_DIR}")
+file(MAKE_DIRECTORY "${WORK_DIR}")
+
+execute_process(
+    COMMAND "${BUGTRACKER}" --import "${INPUT}"
+    WORKING_DIRECTORY "${WORK_DIR}"
+    OUTPUT_VARIABLE output
+    ERROR_VARIABLE errors
+    RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "Import exited with ${result}:\n${output}${errors}")
+endif()
+string(FIND "${output}${errors}" "${EXPECTED}" found)
+if(found EQUAL -1)
+    message(FATAL_ERROR "Expected \"${EXPECTED}\" in the import report:\n${output}${errors}")
+endif()
+
+# The bugs that were imported, in filing order
+execute_process(
+    COMMAND "${BUGTRACKER}" list --format ndjson
+    WORKING_DIRECTORY "${WORK_DIR}"
+    OUTPUT_VARIABLE listing
+    RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "Listing the imported bugs exited with ${result}")
+endif()
+string(REGEX MATCHALL "\"Title\":\"[^\"]*\"" titles "${listing}")
+string(REGEX REPLACE "\"Title\":\"([^\"]*)\"" "\\1" titles "${titles}")
+if(NOT titles STREQUAL EXPECTED_TITLES)
+    message(FATAL_ERROR "Imported titles were \"${titles}\", expected \"${EXPECTED_TITLES}\"")
+endif()
@@ -0,0 +1,34 @@
+# Runs the built-in BugTracker benchmarks; results are printed on stderr.
+# Usage: cmake -DBUGTRACKER=<path to BugTracker> -DBUGTRACKER_BENCH=<path to BugTrackerBench>
+#              -DWORK_DIR=<scratch dir> -P RunBenchmarks.cmake
+
+file(MAKE_DIRECTORY "${WORK_DIR}")
+
+function(run_benchmark name program)
+    message(STATUS "== ${name}")
+    execute_process(
+        COMMAND "${program}" ${ARGN}
+        WORKING_DIRECTORY "${WORK_DIR}"
+        OUTPUT_FILE "${WORK_DIR}/${name}.out"
+        RESULT_VARIABLE result)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "${name} benchmark failed: ${result}")
+    endif()
+endfunction()
+
+run_benchmark(output "${BUGTRACKER}" --bench-output 200000 --page-size 1000)
+run_benchmark(bugid "${BUGTRACKER}" --bench-bugid 100000)
+run_benchmark(lookup "${BUGTRACKER}" --bench-lookup 1000000)
+run_benchmark(profiles "${BUGTRACKER}" --bench-profiles 2000)
+run_benchmark(search "${BUGTRACKER_BENCH}" --search 1000000)
+run_benchmark(writes "${BUGTRACKER_BENCH}" --writes 20000)
+run_benchmark(cache "${BUGTRACKER_BENCH}" --cache 1000000)
+run_benchmark(stats "${BUGTRACKER_BENCH}" --stats 1000000)
+run_benchmark(history "${BUGTRACKER_BENCH}" --history 1000000)
+run_benchmark(filters "${BUGTRACKER_BENCH}" --filters 1000000)
+run_benchmark(export "${BUGTRACKER_BENCH}" --export 1000000)
+
+# CRUD operations at 10^3, 10^5 and 10^7 rows; the table is printed to crud.out
+run_benchmark(crud "${BUGTRACKER_BENCH}")
+file(READ "${WORK_DIR}/crud.out" crud_report)
+message("${crud_report}")